@@ -5,7 +5,7 @@ void Homestead::OnStart(int argc, char* argv[])
     if (IsForeground())
     {
         // May as well do this here, though should really do on foreground.
-        watch->driver->tft->fillScreen(TFT_BLACK);
+        watch->display.GetTFT()->fillScreen(TFT_BLACK);
     }
 
     // Battery text
@@ -58,6 +58,9 @@ void Homestead::OnStart(int argc, char* argv[])
     lastMinute--;
     lastDay--;
     batteryPercentage = 1.1f;
+
+    // The clock and battery only change once a second, and touches invalidate.
+    RequestFrame(1);
 }
 
 void Homestead::OnEnterBackground()
@@ -67,6 +70,7 @@ void Homestead::OnEnterBackground()
 void Homestead::OnEnterForeground()
 {
     refreshBatteryPercent = true;
+    Invalidate();
 }
 
 void Homestead::HandleEvent(Event& e)
@@ -97,10 +101,23 @@ void Homestead::HandleEvent(Event& e)
     }
 
     swipeButton.HandleEvent(e);
+    Invalidate();
 }
 
 void Homestead::Render(Display& display)
 {
+    if (alwaysOnDrawn)
+    {
+        // The always-on face may not be where everything else is drawn, so start over.
+        alwaysOnDrawn = false;
+        display.Clear(TFT_BLACK);
+        wasCharging = !charging;
+        refreshBatteryPercent = true;
+        batteryPercentage = 1.1f;
+        lastMinute = 0xFF;
+        lastDay = 0xFF;
+    }
+
     // TODO: consider using timer instead of RTC to update every minute, maybe more efficient?
     RTC_Date date = watch->driver->rtc->getDateTime();
     if (lastMinute != date.minute)
@@ -184,3 +201,28 @@ void Homestead::Render(Display& display)
 
     lastSecond = date.second;
 }
+
+void Homestead::RenderAlwaysOn(Display& display)
+{
+    if (!alwaysOnDrawn)
+    {
+        // Render() may have left the time anywhere after a drag, so clear the always-on rows first.
+        alwaysOnDrawn = true;
+        alwaysOnMinute = 0xFF;
+        display.FillRect((IntRect){0, ALWAYS_ON_TOP, DISPLAY_WIDTH, ALWAYS_ON_BOTTOM + 1 - ALWAYS_ON_TOP}, TFT_BLACK);
+    }
+
+    // Only the time fits in the always-on rows. It's drawn without the drag offset, centred on the screen, so that it
+    // always lies within them.
+    RTC_Date date = watch->driver->rtc->getDateTime();
+    if (alwaysOnMinute != date.minute)
+    {
+        alwaysOnMinute = date.minute;
+
+        char text[6] = { '\0' };
+        sprintf(text, "%02u:%02u", date.hour, date.minute);
+
+        timeText.SetText(text);
+        timeText.Render(display, Vector2::Zero);
+    }
+}
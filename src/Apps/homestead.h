@@ -26,6 +26,8 @@ public:
 
     void Render(Display& display);
 
+    void RenderAlwaysOn(Display& display);
+
     void OnEnterBackground();
     void OnEnterForeground();
 
@@ -57,6 +59,12 @@ private:
     uint8_t lastMinute = 0;
     uint8_t lastDay = 40;
 
+    // The minute last drawn by RenderAlwaysOn().
+    uint8_t alwaysOnMinute = 0xFF;
+
+    // Whether RenderAlwaysOn() has drawn since the last Render().
+    bool alwaysOnDrawn = false;
+
 };
 
 #endif // HOMESTEAD_H
@@ -86,12 +86,20 @@ static const uint8_t init_240x240[] = {
 };
 // -----------------------------------------
 
+#ifdef ST7789_SPI_STATS
+#define COUNT_BYTES(n)     bytesSent += (n)
+#define COUNT_TRANSACTION  transactions++
+#else
+#define COUNT_BYTES(n)
+#define COUNT_TRANSACTION
+#endif
+
 #ifdef COMPATIBILITY_MODE
 static SPISettings spiSettings;
-#define SPI_START  SPI.beginTransaction(spiSettings)
+#define SPI_START  SPI.beginTransaction(spiSettings); COUNT_TRANSACTION
 #define SPI_END    SPI.endTransaction()
 #else
-#define SPI_START
+#define SPI_START  COUNT_TRANSACTION
 #define SPI_END
 #endif
 
@@ -118,9 +126,13 @@ static SPISettings spiSettings;
 // speed test results:
 // in AVR best performance mode -> about 6.9 Mbps
 // in compatibility mode (SPI.transfer(c)) -> about 4 Mbps
+// in ESP32 bulk mode at 40MHz -> about 36 Mbps for windows, commands are still sent a byte at a time
 inline void Arduino_ST7789::writeSPI(uint8_t c)
 {
-#ifdef COMPATIBILITY_MODE
+  COUNT_BYTES(1);
+#if defined(ESP32_BULK_MODE)
+    SPI.write(c);  // no need to wait for a byte to be read back
+#elif defined(COMPATIBILITY_MODE)
     SPI.transfer(c);
 #else
     SPDR = c;
@@ -146,7 +158,11 @@ inline void Arduino_ST7789::writeSPI(uint8_t c)
 // fast method to send multiple 16-bit values via SPI
 inline void Arduino_ST7789::writeMulti(uint16_t color, uint16_t num)
 {
-#ifdef COMPATIBILITY_MODE
+  COUNT_BYTES((uint32_t)num*2);
+#if defined(ESP32_BULK_MODE)
+  uint8_t pattern[2] = { (uint8_t)(color>>8), (uint8_t)color };
+  SPI.writePattern(pattern, 2, num);
+#elif defined(COMPATIBILITY_MODE)
   while(num--) { SPI.transfer(color>>8);  SPI.transfer(color); }
 #else
   asm volatile
@@ -181,7 +197,10 @@ inline void Arduino_ST7789::writeMulti(uint16_t color, uint16_t num)
 // fast method to send multiple 16-bit values from RAM via SPI
 inline void Arduino_ST7789::copyMulti(uint8_t *img, uint16_t num)
 {
-#ifdef COMPATIBILITY_MODE
+  COUNT_BYTES((uint32_t)num*2);
+#if defined(ESP32_BULK_MODE)
+  SPI.writePixels(img, (uint32_t)num*2);  // swaps each pixel to high byte first as it fills the FIFO
+#elif defined(COMPATIBILITY_MODE)
   while(num--) { SPI.transfer(*(img+1)); SPI.transfer(*(img+0)); img+=2; }
 #else
   uint8_t lo,hi;
@@ -213,6 +232,18 @@ inline void Arduino_ST7789::copyMulti(uint8_t *img, uint16_t num)
   );
 #endif
 }
+// ----------------------------------------------------------
+// sends bytes from RAM exactly as they are, for images already in panel order (high byte first)
+inline void Arduino_ST7789::copyRaw(const uint8_t *img, uint32_t num)
+{
+#if defined(ESP32_BULK_MODE)
+  COUNT_BYTES(num);
+  SPI.writeBytes(img, num);
+#else
+  while(num--) writeSPI(*img++);
+#endif
+}
+
 // ----------------------------------------------------------
 Arduino_ST7789::Arduino_ST7789(int8_t dc, int8_t rst, int8_t cs) : Adafruit_GFX(ST7789_TFTWIDTH, ST7789_TFTHEIGHT)
 {
@@ -320,10 +351,14 @@ void Arduino_ST7789::commonST7789Init(const uint8_t *cmdList)
 #endif
 
   // on AVR ST7789 works correctly in MODE2 and MODE3 but for STM32 only MODE3 seems to be working
+#if defined(ESP32_BULK_MODE)
+  SPI.begin(ST7789_SCLK_PIN, -1, ST7789_MOSI_PIN, -1);
+  spiSettings = SPISettings(ST7789_SPI_FREQUENCY, MSBFIRST, SPI_MODE3);
+#elif defined(COMPATIBILITY_MODE)
   SPI.begin();
-#ifdef COMPATIBILITY_MODE
   spiSettings = SPISettings(16000000, MSBFIRST, SPI_MODE3);  // 8000000 gives max speed on AVR 16MHz
 #else
+  SPI.begin();
   SPI.setClockDivider(SPI_CLOCK_DIV2);
   SPI.setDataMode(SPI_MODE3);
 #endif
@@ -506,6 +541,19 @@ void Arduino_ST7789::drawImage(int16_t x, int16_t y, int16_t w, int16_t h, uint1
   SPI_END;
 }
 
+// ----------------------------------------------------------
+// draws image from RAM that is already high byte first, e.g. a PF_RGB565_BE surface, without swapping
+void Arduino_ST7789::drawImageRaw(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *img16)
+{
+  if(w<=0 || h<=0) return;
+  setAddrWindow(x, y, x+w-1, y+h-1);
+
+  copyRaw((const uint8_t *)img16, (uint32_t)w*h*2);
+
+  CS_IDLE;
+  SPI_END;
+}
+
 // ----------------------------------------------------------
 // draws image from flash (PROGMEM)
 void Arduino_ST7789::drawImageF(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *img16)
@@ -514,6 +562,10 @@ void Arduino_ST7789::drawImageF(int16_t x, int16_t y, int16_t w, int16_t h, cons
   setAddrWindow(x, y, x+w-1, y+h-1);
 
   uint32_t num = (uint32_t)w*h;
+#ifdef ESP32_BULK_MODE
+  // flash is memory mapped on ESP32
+  copyMulti((uint8_t *)img16, num);
+#else
   uint16_t num16 = num>>3;
   uint8_t *img = (uint8_t *)img16;
   while(num16--) {
@@ -528,6 +580,7 @@ void Arduino_ST7789::drawImageF(int16_t x, int16_t y, int16_t w, int16_t h, cons
   }
   uint8_t num8 = num & 0x7;
   while(num8--) { writeSPI(pgm_read_byte(img+1)); writeSPI(pgm_read_byte(img+0)); img+=2; }
+#endif
 
   CS_IDLE;
   SPI_END;
@@ -11,6 +11,20 @@
 
 // define for LCD boards where CS pin is internally connected to the ground
 #define CS_ALWAYS_LOW
+
+// on ESP32 send whole windows with the SPI peripheral's bulk writes instead of a byte at a time
+// (builds on COMPATIBILITY_MODE for the DC/CS pins and transactions)
+#if defined(ARDUINO_ARCH_ESP32) && defined(COMPATIBILITY_MODE)
+#define ESP32_BULK_MODE
+// T-Watch 2020 display pins
+#define ST7789_SCLK_PIN 18
+#define ST7789_MOSI_PIN 19
+// 80MHz only works on the VSPI IO_MUX pins, other pins are limited to 40MHz by the GPIO matrix
+#define ST7789_SPI_FREQUENCY 40000000
+#endif
+
+// define to count bytes and SPI transactions sent, e.g. per frame
+//#define ST7789_SPI_STATS
 // ------------------------------
 
 #include "Arduino.h"
@@ -61,6 +75,7 @@ class Arduino_ST7789 : public Adafruit_GFX {
   void drawImage(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *img);
   void drawImageF(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *img16);
   void drawImageF(int16_t x, int16_t y, const uint16_t *img16) { drawImageF(x,y,pgm_read_word(img16),pgm_read_word(img16+1),img16+3); }
+  void drawImageRaw(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *img);
   void setRotation(uint8_t r);
   void invertDisplay(boolean mode);
   void partialDisplay(boolean mode);
@@ -79,6 +94,13 @@ class Arduino_ST7789 : public Adafruit_GFX {
   void rgbWheel(int idx, uint8_t *_r, uint8_t *_g, uint8_t *_b);
   uint16_t rgbWheel(int idx);
 
+#ifdef ST7789_SPI_STATS
+  // bytes and transactions sent since the last resetStats()
+  uint32_t getBytesSent() { return bytesSent; }
+  uint32_t getTransactions() { return transactions; }
+  void resetStats() { bytesSent = 0; transactions = 0; }
+#endif
+
  protected:
   uint8_t _colstart, _rowstart, _xstart, _ystart;
 
@@ -86,6 +108,7 @@ class Arduino_ST7789 : public Adafruit_GFX {
   void writeSPI(uint8_t);
   void writeMulti(uint16_t color, uint16_t num);
   void copyMulti(uint8_t *img, uint16_t num);
+  void copyRaw(const uint8_t *img, uint32_t num);
   void writeCmd(uint8_t c);
   void writeData(uint8_t d8);
   void writeData16(uint16_t d16);
@@ -95,6 +118,10 @@ class Arduino_ST7789 : public Adafruit_GFX {
   int8_t  csPin, dcPin, rstPin;
   uint8_t  csMask, dcMask;
   volatile uint8_t  *csPort, *dcPort;
+#ifdef ST7789_SPI_STATS
+  uint32_t bytesSent = 0;
+  uint32_t transactions = 0;
+#endif
 
 };
 
@@ -21,6 +21,33 @@ bool Application::IsForeground()
     return _foreground;
 }
 
+void Application::Invalidate()
+{
+    _invalidated = true;
+}
+
+void Application::RequestFrame(uint32_t rate)
+{
+    _frameInterval = rate > 0 ? max(1000 / rate, (uint32_t)1) : 0;
+    _nextFrame = millis();
+}
+
+bool Application::IsFrameDue(uint32_t now)
+{
+    return _invalidated || (_frameInterval > 0 && (int32_t)(now - _nextFrame) >= 0);
+}
+
+void Application::FrameRendered(uint32_t now)
+{
+    _invalidated = false;
+    _nextFrame += _frameInterval;
+    if ((int32_t)(now - _nextFrame) >= 0)
+    {
+        // Fell behind, so don't try to catch up.
+        _nextFrame = now + _frameInterval;
+    }
+}
+
 void Application::HandleEvent(Event& e)
 {
 }
@@ -32,3 +59,74 @@ void Application::Update()
 void Application::Render(Display& display)
 {
 }
+
+void Application::RenderAlwaysOn(Display& display)
+{
+}
+
+Surface* Application::CreateScratchSurface(uint32_t w, uint32_t h, uint8_t format, uint8_t placement)
+{
+    Surface* surface = new Surface();
+    surface->Init(w, h, format, placement);
+    if (surface->GetPixels() == nullptr)
+    {
+        delete surface;
+        return nullptr;
+    }
+    scratchSurfaces.push_back(surface);
+    return surface;
+}
+
+void Application::DestroyScratchSurface(Surface* surface)
+{
+    for (unsigned int i = 0, counti = scratchSurfaces.size(); i < counti; i++)
+    {
+        if (scratchSurfaces[i] == surface)
+        {
+            surface->Destroy();
+            delete surface;
+            scratchSurfaces.erase(scratchSurfaces.begin() + i);
+            return;
+        }
+    }
+}
+
+void Application::DestroyScratchSurfaces()
+{
+    for (unsigned int i = 0, counti = scratchSurfaces.size(); i < counti; i++)
+    {
+        scratchSurfaces[i]->Destroy();
+        delete scratchSurfaces[i];
+    }
+    scratchSurfaces.clear();
+}
+
+Layer* Application::CreateLayer(int w, int h, uint8_t placement)
+{
+    DestroyLayer();
+    layer = new Layer();
+    if (!layer->Init(w, h, placement))
+    {
+        delete layer;
+        layer = nullptr;
+        return nullptr;
+    }
+    watch->compositor.AddLayer(layer);
+    return layer;
+}
+
+Layer* Application::GetLayer()
+{
+    return layer;
+}
+
+void Application::DestroyLayer()
+{
+    if (layer != nullptr)
+    {
+        watch->compositor.RemoveLayer(layer);
+        layer->Destroy();
+        delete layer;
+        layer = nullptr;
+    }
+}
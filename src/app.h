@@ -2,6 +2,7 @@
 #define APP_H
 
 #include "kernel.h"
+#include <vector>
 
 class Application
 {
@@ -23,26 +24,80 @@ public:
     // Handle an input event.
     virtual void HandleEvent(Event& e);
 
-    // Update logic once per frame.
+    // Update logic once per frame. While no app needs to render, frames stretch until the next one that does, or an input event.
     virtual void Update();
 
-    // Render stuff to the display.
+    // Render stuff to the display. Only called on frames where this app is due to render, see RequestFrame().
     virtual void Render(Display& display);
 
+    // Render the always-on watch face, once a minute while the kernel is inactive in always-on mode.
+    // Only the rows from ALWAYS_ON_TOP to ALWAYS_ON_BOTTOM are shown, in 8 colours, and the CPU runs at 10MHz.
+    // This draws straight to the display, even if the app has a layer.
+    virtual void RenderAlwaysOn(Display& display);
+
     // Is this app running in the foreground?
     bool IsForeground();
 
+    // Asks for Render() to be called on the next frame, e.g. after something shown on screen has changed.
+    void Invalidate();
+
+    // Asks for Render() to be called rate times a second, as well as after Invalidate().
+    // A rate of 0 only renders when invalidated. Apps render every frame until they call this.
+    void RequestFrame(uint32_t rate);
+
 protected:
     // Reference to the watch runtime itself.
     Kernel* watch;
 
+    // Creates a surface owned by this app, which is returned to the surface pool when the app is killed.
+    // Returns nullptr if the surface can't be allocated.
+    Surface* CreateScratchSurface(uint32_t w, uint32_t h, uint8_t format = PF_RGB565, uint8_t placement = PLACEMENT_PSRAM);
+
+    // Returns a scratch surface to the surface pool before the app is killed.
+    void DestroyScratchSurface(Surface* surface);
+
+    // Gives this app a layer of a given size, which Render() then draws into instead of the display. The kernel composes
+    // layers into the render buffer by position, z-order and opacity, and only where they have changed.
+    // Returns nullptr if the layer can't be allocated.
+    Layer* CreateLayer(int w, int h, uint8_t placement = PLACEMENT_SRAM);
+
+    // Returns the layer of this app, or nullptr if it renders straight to the display.
+    Layer* GetLayer();
+
+    // Removes the layer of this app, so that it renders straight to the display again.
+    void DestroyLayer();
+
 private:
+    // Returns all scratch surfaces to the surface pool.
+    void DestroyScratchSurfaces();
+
+    // Surfaces created by CreateScratchSurface().
+    std::vector<Surface*> scratchSurfaces;
+
+    // Layer created by CreateLayer().
+    Layer* layer = nullptr;
+
     // This application's runtime task ID.
     int _id = -1;
 
     // Returned by IsForeground().
     bool _foreground = false;
 
+    // Is a frame due at a given time in milliseconds?
+    bool IsFrameDue(uint32_t now);
+
+    // Schedules the next frame after rendering one at a given time in milliseconds.
+    void FrameRendered(uint32_t now);
+
+    // Whether Invalidate() has been called since the last frame.
+    bool _invalidated = true;
+
+    // Milliseconds between requested frames, or 0 to only render when invalidated.
+    uint32_t _frameInterval = DISPLAY_REFRESH_DELAY;
+
+    // When the next requested frame is due, in milliseconds.
+    uint32_t _nextFrame = 0;
+
 };
 
 #endif // APP_H
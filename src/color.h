@@ -8,4 +8,36 @@ uint16_t Color(uint16_t r, uint16_t g, uint16_t b);
 
 #define COLOR(R, G, B) (((R >> 3) << 11) | ((G >> 2) << 5) | (B >> 3))
 
+// Spreads an RGB565 color across 32 bits as 00000GGGGGG00000RRRRR000000BBBBB,
+// leaving enough headroom between channels to weight all three with a single multiply.
+inline uint32_t Expand565(uint16_t c)
+{
+    return (c | ((uint32_t)c << 16)) & 0x07E0F81F;
+}
+
+// Packs an expanded color back into RGB565.
+inline uint16_t Pack565(uint32_t c)
+{
+    c &= 0x07E0F81F;
+    return (uint16_t)(c | (c >> 16));
+}
+
+// Linearly interpolates between two expanded colors with a 5-bit weight in the range [0, 32].
+inline uint32_t Lerp565(uint32_t a, uint32_t b, uint32_t weight)
+{
+    return ((a * (32 - weight) + b * weight) >> 5) & 0x07E0F81F;
+}
+
+// Swaps the bytes of an RGB565 color, between native order and the big-endian order the panel expects.
+inline uint16_t Swap565(uint16_t c)
+{
+    return (uint16_t)((c << 8) | (c >> 8));
+}
+
+// Blends an RGB565 color over another with a 5-bit weight in the range [0, 32].
+inline uint16_t Blend565(uint16_t dest, uint16_t src, uint32_t weight)
+{
+    return Pack565(Lerp565(Expand565(dest), Expand565(src), weight));
+}
+
 #endif // COLOR_H
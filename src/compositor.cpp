@@ -0,0 +1,202 @@
+#include <algorithm>
+#include "compositor.h"
+
+// Returns the overlap of two rects, with zero size if they don't overlap.
+static IntRect Intersect(IntRect a, IntRect b)
+{
+    int startX = max(a.x, b.x);
+    int startY = max(a.y, b.y);
+    int endX = min(a.x + a.w, b.x + b.w);
+    int endY = min(a.y + a.h, b.y + b.h);
+    return (IntRect){startX, startY, max(endX - startX, 0), max(endY - startY, 0)};
+}
+
+// Returns the bounds of two rects; rects of zero size are ignored.
+static IntRect Union(IntRect a, IntRect b)
+{
+    if (a.w <= 0 || a.h <= 0)
+    {
+        return b;
+    }
+    if (b.w <= 0 || b.h <= 0)
+    {
+        return a;
+    }
+    int startX = min(a.x, b.x);
+    int startY = min(a.y, b.y);
+    int endX = max(a.x + a.w, b.x + b.w);
+    int endY = max(a.y + a.h, b.y + b.h);
+    return (IntRect){startX, startY, endX - startX, endY - startY};
+}
+
+// Does a contain the whole of b?
+static bool Contains(IntRect a, IntRect b)
+{
+    return b.x >= a.x && b.y >= a.y && b.x + b.w <= a.x + a.w && b.y + b.h <= a.y + a.h;
+}
+
+// Blends an area of an RGB565 surface over an RGB565 or PF_RGB565_BE surface with a constant opacity.
+static void BlendArea(Surface* src, IntRect srcArea, Surface* dest, int x, int y, uint8_t opacity)
+{
+    uint32_t weight = (opacity + 4) >> 3;
+    if (dest->GetFormat() == PF_RGB565_BE)
+    {
+        for (int j = 0; j < srcArea.h; j++)
+        {
+            const uint16_t* in = (const uint16_t*)((uint8_t*)src->GetPixels() + ((srcArea.y + j) * src->GetPitch())) + srcArea.x;
+            uint16_t* out = (uint16_t*)((uint8_t*)dest->GetPixels() + ((y + j) * dest->GetPitch())) + x;
+            for (int i = 0; i < srcArea.w; i++)
+            {
+                out[i] = Swap565(Blend565(Swap565(out[i]), in[i], weight));
+            }
+        }
+        return;
+    }
+    for (int j = 0; j < srcArea.h; j++)
+    {
+        const uint16_t* in = (const uint16_t*)((uint8_t*)src->GetPixels() + ((srcArea.y + j) * src->GetPitch())) + srcArea.x;
+        uint16_t* out = (uint16_t*)((uint8_t*)dest->GetPixels() + ((y + j) * dest->GetPitch())) + x;
+        for (int i = 0; i < srcArea.w; i++)
+        {
+            out[i] = Blend565(out[i], in[i], weight);
+        }
+    }
+}
+
+void Compositor::AddLayer(Layer* layer)
+{
+    if (std::find(layers.begin(), layers.end(), layer) == layers.end())
+    {
+        layers.insert(layers.begin(), layer);
+        layer->MarkAllChanged();
+    }
+}
+
+void Compositor::RemoveLayer(Layer* layer)
+{
+    auto itr = std::find(layers.begin(), layers.end(), layer);
+    if (itr != layers.end())
+    {
+        removed = Union(removed, layer->GetArea());
+        layers.erase(itr);
+    }
+}
+
+void Compositor::SetBackground(uint16_t color)
+{
+    if (color != background)
+    {
+        background = color;
+        removed = (IntRect){0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT};
+    }
+}
+
+uint16_t Compositor::GetBackground()
+{
+    return background;
+}
+
+bool Compositor::Compose(Display& display)
+{
+    // Layers are composed into a full size render buffer, which the strip backend doesn't keep.
+    if ((int)display.GetBuffer()->GetHeight() < DISPLAY_HEIGHT)
+    {
+        return false;
+    }
+
+    // Bottom to top. The sort is stable, so the newest layers stay beneath older ones of the same z.
+    std::stable_sort(layers.begin(), layers.end(), [] (Layer* a, Layer* b) { return a->z < b->z; });
+
+    // Each changed area is composed separately, unless it overlaps another.
+    std::vector<IntRect> areas;
+    if (removed.w > 0 && removed.h > 0)
+    {
+        areas.push_back(removed);
+        removed = (IntRect){0, 0, 0, 0};
+    }
+    for (unsigned int i = 0, counti = layers.size(); i < counti; i++)
+    {
+        Layer* layer = layers[i];
+        if (!layer->IsChanged())
+        {
+            continue;
+        }
+        IntRect area = layer->damage;
+        layer->damage = (IntRect){0, 0, 0, 0};
+        // Merging can make the area overlap others it didn't before, so keep going until nothing overlaps.
+        bool merged = true;
+        while (merged)
+        {
+            merged = false;
+            for (unsigned int j = 0; j < areas.size(); j++)
+            {
+                IntRect overlap = Intersect(areas[j], area);
+                if (overlap.w > 0 && overlap.h > 0)
+                {
+                    area = Union(areas[j], area);
+                    areas.erase(areas.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+        areas.push_back(area);
+    }
+
+    for (unsigned int i = 0, counti = areas.size(); i < counti; i++)
+    {
+        IntRect area = Intersect(areas[i], (IntRect){0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT});
+        if (area.w > 0 && area.h > 0)
+        {
+            ComposeArea(display, area);
+        }
+    }
+    return !areas.empty();
+}
+
+void Compositor::ComposeArea(Display& display, IntRect area)
+{
+    // Anything beneath the highest opaque layer covering the whole area is hidden.
+    int start = -1;
+    for (int i = layers.size() - 1; i >= 0; i--)
+    {
+        Layer* layer = layers[i];
+        if (layer->visible && layer->opacity == 255 && Contains(layer->GetArea(), area))
+        {
+            start = i;
+            break;
+        }
+    }
+
+    Surface* buffer = display.GetBuffer();
+    if (start < 0)
+    {
+        buffer->FillRect(area, buffer->GetFormat() == PF_RGB565_BE ? Swap565(background) : background);
+        start = 0;
+    }
+
+    for (unsigned int i = start, counti = layers.size(); i < counti; i++)
+    {
+        Layer* layer = layers[i];
+        if (!layer->visible || layer->opacity == 0)
+        {
+            continue;
+        }
+        IntRect dest = Intersect(layer->GetArea(), area);
+        if (dest.w <= 0 || dest.h <= 0)
+        {
+            continue;
+        }
+        IntRect src = (IntRect){dest.x - layer->x, dest.y - layer->y, dest.w, dest.h};
+        if (layer->opacity == 255)
+        {
+            layer->surface.Blit(buffer, &dest, &src);
+        }
+        else
+        {
+            BlendArea(&layer->surface, src, buffer, dest.x, dest.y, layer->opacity);
+        }
+    }
+
+    display.MarkDirty(area);
+}
@@ -0,0 +1,44 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <vector>
+#include "display.h"
+#include "layer.h"
+
+/// Composes app layers into the render buffer of a display by z-order.
+/// Only areas of the screen that have changed are composed, starting from the highest opaque layer that covers each area
+/// so that layers hidden beneath it cost nothing.
+class Compositor
+{
+public:
+    // Adds a layer to be composed. Among layers with the same z, layers added first are composed on top.
+    void AddLayer(Layer* layer);
+
+    // Stops composing a layer; the area it covered is composed again.
+    void RemoveLayer(Layer* layer);
+
+    // Set the color shown where no opaque layer covers the screen.
+    void SetBackground(uint16_t color);
+
+    // Return the color shown where no opaque layer covers the screen.
+    uint16_t GetBackground();
+
+    // Composes the changed areas of all layers into the render buffer and marks them dirty.
+    // Returns false if nothing has changed since the last call.
+    bool Compose(Display& display);
+
+private:
+    // Composes all layers within an area of the screen.
+    void ComposeArea(Display& display, IntRect area);
+
+    // Layers to compose, newest first.
+    std::vector<Layer*> layers;
+
+    // Area left behind by removed layers.
+    IntRect removed = {0, 0, 0, 0};
+
+    uint16_t background = TFT_BLACK;
+
+};
+
+#endif // COMPOSITOR_H
@@ -189,7 +189,7 @@ void Point::Draw(Display& display)
 
 void Point::Draw(Display& display, uint16_t color)
 {
-    display.GetTFT()->drawPixel((int)x, (int)y, color);
+    display.DrawPixel((int)x, (int)y, color);
 }
 
 bool Point::Intersects(Circle circle)
@@ -243,7 +243,6 @@ InfiniteLine::InfiniteLine(Point p, Vector2 direction)
 /// Circle
 ///
 
-/// TODO: use a more efficient drawing algorithm
 void Circle::Draw(Display& display)
 {
     Draw(display, display.GetDrawColor());
@@ -251,7 +250,7 @@ void Circle::Draw(Display& display)
 
 void Circle::Draw(Display& display, uint16_t color)
 {
-    display.GetTFT()->drawCircle((int)x, (int)y, (int)r, color);
+    display.DrawCircle((int)x, (int)y, (int)r, color);
 }
 
 void Circle::DrawFilled(Display& display)
@@ -261,7 +260,17 @@ void Circle::DrawFilled(Display& display)
 
 void Circle::DrawFilled(Display& display, uint16_t color)
 {
-    display.GetTFT()->fillCircle((int)x, (int)y, (int)r, color);
+    display.FillCircle((int)x, (int)y, (int)r, color);
+}
+
+void Circle::DrawAntialiased(Display& display)
+{
+    DrawAntialiased(display, display.GetDrawColor());
+}
+
+void Circle::DrawAntialiased(Display& display, uint16_t color)
+{
+    display.DrawCircleAA((int)x, (int)y, (int)r, color);
 }
 
 bool Circle::Intersects(Circle circle)
@@ -335,7 +344,17 @@ void Line::Draw(Display& display)
 
 void Line::Draw(Display& display, uint16_t color)
 {
-    display.GetTFT()->drawLine((int)a.x, (int)a.y, (int)b.x, (int)b.y, color);
+    display.DrawLine((int)a.x, (int)a.y, (int)b.x, (int)b.y, color);
+}
+
+void Line::DrawAntialiased(Display& display)
+{
+    DrawAntialiased(display, display.GetDrawColor());
+}
+
+void Line::DrawAntialiased(Display& display, uint16_t color)
+{
+    display.DrawLineAA(a.x, a.y, b.x, b.y, color);
 }
 
 ///
@@ -370,7 +389,7 @@ void Rect::DrawFilled(Display& display)
 void Rect::DrawFilled(Display& display, uint16_t color)
 {
     IntRect rect = Int();
-    display.GetTFT()->fillRect(rect.x, rect.y, rect.w, rect.h, color);
+    display.FillRect(rect, color);
 }
 
 void Rect::Draw(Display& display)
@@ -381,10 +400,10 @@ void Rect::Draw(Display& display)
 void Rect::Draw(Display& display, uint16_t color)
 {
     IntRect rect = Int();
-    display.GetTFT()->drawFastHLine(rect.x, rect.y, rect.w, color);
-    display.GetTFT()->drawFastVLine(rect.x, rect.y, rect.h, color);
-    display.GetTFT()->drawFastVLine(rect.x + rect.w, rect.y, rect.h, color);
-    display.GetTFT()->drawFastHLine(rect.x, rect.y + rect.h, rect.w, color);
+    display.DrawHLine(rect.x, rect.y, rect.w, color);
+    display.DrawVLine(rect.x, rect.y, rect.h, color);
+    display.DrawVLine(rect.x + rect.w, rect.y, rect.h, color);
+    display.DrawHLine(rect.x, rect.y + rect.h, rect.w, color);
 }
 
 bool Rect::Intersects(Circle circle)
@@ -431,19 +450,42 @@ bool Rect::operator!=(const Rect& rect)
     return !(*this == rect);
 }
 
+///
+/// Triangle
+///
+
+void Triangle::Draw(Display& display)
+{
+    Draw(display, display.GetDrawColor());
+}
+
+void Triangle::Draw(Display& display, uint16_t color)
+{
+    display.DrawTriangle((int)a.x, (int)a.y, (int)b.x, (int)b.y, (int)c.x, (int)c.y, color);
+}
+
+void Triangle::DrawFilled(Display& display)
+{
+    DrawFilled(display, display.GetDrawColor());
+}
+
+void Triangle::DrawFilled(Display& display, uint16_t color)
+{
+    display.FillTriangle((int)a.x, (int)a.y, (int)b.x, (int)b.y, (int)c.x, (int)c.y, color);
+}
+
 ///
 /// Polygon
 ///
 
 void Polygon::DrawFilled(Display& display)
 {
-    /// TODO: this
+    DrawFilled(display, display.GetDrawColor());
 }
 
 void Polygon::DrawFilled(Display& display, uint16_t color)
 {
-    display.SetDrawColor(color);
-    DrawFilled(display);
+    display.FillPolygon(vertices.data(), vertices.size(), color);
 }
 
 void Polygon::Draw(Display& display, uint16_t color)
@@ -161,6 +161,10 @@ struct Circle
     void DrawFilled(Display& display);
     void DrawFilled(Display& display, uint16_t color);
 
+    /// Draws the outline with anti-aliasing
+    void DrawAntialiased(Display& display);
+    void DrawAntialiased(Display& display, uint16_t color);
+
     /// Whether or not this rect is intersecting a circle
     bool Intersects(Circle circle);
     /// Whether or not this rect is intersecting an infinite line
@@ -201,6 +205,10 @@ struct Line
     void Draw(Display& display);
     void Draw(Display& display, uint16_t color);
 
+    /// Draws with anti-aliasing, keeping the sub-pixel position of each end
+    void DrawAntialiased(Display& display);
+    void DrawAntialiased(Display& display, uint16_t color);
+
 };
 
 /// Floating point rectangle; if you want an integer based rectangle, use IntRect instead
@@ -5,12 +5,21 @@
 void Display::Init(TTGOClass* watch)
 {
     device = watch;
-    renderBuffer.Init(240, 240, PF_RGB565);
+#ifdef RENDER_STRIPS
+    backend = RENDERBACKEND_STRIPS;
+    int height = DISPLAY_STRIP_HEIGHT;
+#else
+    int height = DISPLAY_HEIGHT;
+#endif // RENDER_STRIPS
+    AllocateBuffers(PF_RGB565, height);
+#ifdef DISPLAY_DAMAGE_TRACKING
+    damageTracking = true;
+#endif // DISPLAY_DAMAGE_TRACKING
+    glyphCache.Init(GetTFT());
 #ifdef RENDER_DMA
     // Use DMA for fast rendering.
-    dmaBuffer.Init(240, 240, PF_RGB565);
     GetTFT()->initDMA();
-    GetTFT()->setAddrWindow(0, 0, 240, 240);
+    GetTFT()->setAddrWindow(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
 #endif // RENDER_DMA
 
 #ifdef OPTIMISED_RENDERING
@@ -21,8 +30,13 @@ void Display::Init(TTGOClass* watch)
 
 void Display::Destroy()
 {
+    WaitPresent();
+    ForgetCommands();
+    glyphCache.Destroy();
+    imageDecoder.Destroy();
     renderBuffer.Destroy();
 #ifdef RENDER_DMA
+    GetTFT()->deInitDMA();
     dmaBuffer.Destroy();
 #endif // RENDER_DMA
 #ifdef OPTIMISED_RENDERING
@@ -32,6 +46,7 @@ void Display::Destroy()
 
 void Display::Enable()
 {
+    ExitAlwaysOn();
     if (!enabled)
     {
         // Power up the backlight
@@ -49,6 +64,7 @@ void Display::Enable()
 
 void Display::Disable()
 {
+    ExitAlwaysOn();
     if (enabled)
     {
         // Sleep the display
@@ -90,9 +106,640 @@ bool Display::IsEnabled()
     return enabled;
 }
 
+void Display::EnterAlwaysOn(int top, int bottom)
+{
+    Enable();
+    // The partial area is in rows of panel memory, so the screen must not be scrolled.
+    ResetScroll();
+    WaitPresent();
+
+#ifdef OPTIMISED_RENDERING
+    tftspi->setPartArea(top, bottom);
+    tftspi->partialDisplay(true);
+    tftspi->idleDisplay(true);
+#else
+    TFT_eSPI* tft = device->tft;
+    // PTLAR, the rows shown in partial mode.
+    tft->writecommand(0x30);
+    tft->writedata(top >> 8);
+    tft->writedata(top & 0xFF);
+    tft->writedata(bottom >> 8);
+    tft->writedata(bottom & 0xFF);
+    // PTLON, then IDMON for 8 colours.
+    tft->writecommand(0x12);
+    tft->writecommand(0x39);
+#endif // OPTIMISED_RENDERING
+
+    alwaysOnBrightness = brightness;
+    device->setBrightness(min(brightness, (uint8_t)DISPLAY_ALWAYS_ON_BRIGHTNESS));
+    alwaysOn = true;
+}
+
+void Display::ExitAlwaysOn()
+{
+    if (!alwaysOn)
+    {
+        return;
+    }
+    alwaysOn = false;
+
+#ifdef OPTIMISED_RENDERING
+    tftspi->idleDisplay(false);
+    tftspi->partialDisplay(false);
+#else
+    TFT_eSPI* tft = device->tft;
+    // IDMOFF, then NORON to leave partial mode.
+    tft->writecommand(0x38);
+    tft->writecommand(0x13);
+#endif // OPTIMISED_RENDERING
+
+    SetBrightnessLevel(alwaysOnBrightness);
+    // The rest of the screen may be out of date.
+    MarkAllDirty();
+}
+
+bool Display::IsAlwaysOn()
+{
+    return alwaysOn;
+}
+
+void Display::SetRenderBackend(RenderBackend backend)
+{
+    if (layer != nullptr)
+    {
+        // Drawing carries on into the layer, the backend is switched when it ends.
+        layerBackend = backend;
+        return;
+    }
+
+    // The strip backend only needs a band of buffer and the buffer backend needs all of it;
+    // the TFT backend keeps whichever is allocated.
+    int height = renderBuffer.GetHeight();
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        height = DISPLAY_STRIP_HEIGHT;
+    }
+    else if (backend == RENDERBACKEND_BUFFER)
+    {
+        height = DISPLAY_HEIGHT;
+    }
+    if (height != (int)renderBuffer.GetHeight())
+    {
+        ResetScroll();
+        AllocateBuffers(renderBuffer.GetFormat(), height);
+    }
+    if (backend != RENDERBACKEND_STRIPS)
+    {
+        ForgetCommands();
+    }
+    this->backend = backend;
+}
+
+RenderBackend Display::GetRenderBackend()
+{
+    return (RenderBackend)backend;
+}
+
+Rasterizer* Display::GetRasterizer()
+{
+    return &rasterizer;
+}
+
+GlyphCache* Display::GetGlyphCache()
+{
+    return &glyphCache;
+}
+
 void Display::Clear(uint16_t color)
 {
-    renderBuffer.Clear(color);
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->fillScreen(color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        // Everything recorded so far is covered up.
+        ForgetCommands();
+        Record(DRAWCOMMAND_FILL_RECT, ToTargetColor(color), {0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT});
+    }
+    else
+    {
+        rasterizer.GetTarget()->Clear(ToTargetColor(color));
+    }
+    MarkAllDirty();
+}
+
+void Display::FillRect(IntRect area, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->fillRect(area.x, area.y, area.w, area.h, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_FILL_RECT, ToTargetColor(color), {area.x, area.y, area.w, area.h});
+    }
+    else
+    {
+        rasterizer.FillRect(area, ToTargetColor(color));
+    }
+    MarkDirty(area);
+}
+
+void Display::DrawPixel(int x, int y, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->drawPixel(x, y, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_PIXEL, ToTargetColor(color), {x, y});
+    }
+    else
+    {
+        rasterizer.DrawPixel(x, y, ToTargetColor(color));
+    }
+    MarkDirty((IntRect){x, y, 1, 1});
+}
+
+void Display::DrawHLine(int x, int y, int w, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->drawFastHLine(x, y, w, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_HLINE, ToTargetColor(color), {x, y, w});
+    }
+    else
+    {
+        rasterizer.DrawHLine(x, y, w, ToTargetColor(color));
+    }
+    MarkDirty((IntRect){x, y, w, 1});
+}
+
+void Display::DrawVLine(int x, int y, int h, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->drawFastVLine(x, y, h, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_VLINE, ToTargetColor(color), {x, y, h});
+    }
+    else
+    {
+        rasterizer.DrawVLine(x, y, h, ToTargetColor(color));
+    }
+    MarkDirty((IntRect){x, y, 1, h});
+}
+
+void Display::DrawLine(int x0, int y0, int x1, int y1, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->drawLine(x0, y0, x1, y1, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_LINE, ToTargetColor(color), {x0, y0, x1, y1});
+    }
+    else
+    {
+        rasterizer.DrawLine(x0, y0, x1, y1, ToTargetColor(color));
+    }
+    MarkDirty((IntRect){min(x0, x1), min(y0, y1), abs(x1 - x0) + 1, abs(y1 - y0) + 1});
+}
+
+void Display::DrawCircle(int x, int y, int r, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->drawCircle(x, y, r, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_CIRCLE, ToTargetColor(color), {x, y, r});
+    }
+    else
+    {
+        rasterizer.DrawCircle(x, y, r, ToTargetColor(color));
+    }
+    MarkDirty((IntRect){x - r, y - r, (2 * r) + 1, (2 * r) + 1});
+}
+
+void Display::FillCircle(int x, int y, int r, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->fillCircle(x, y, r, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_FILL_CIRCLE, ToTargetColor(color), {x, y, r});
+    }
+    else
+    {
+        rasterizer.FillCircle(x, y, r, ToTargetColor(color));
+    }
+    MarkDirty((IntRect){x - r, y - r, (2 * r) + 1, (2 * r) + 1});
+}
+
+void Display::DrawLineAA(float x0, float y0, float x1, float y1, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->drawLine((int)lroundf(x0), (int)lroundf(y0), (int)lroundf(x1), (int)lroundf(y1), color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        DrawCommand& command = Record(DRAWCOMMAND_LINE_AA, ToTargetColor(color));
+        command.f[0] = x0;
+        command.f[1] = y0;
+        command.f[2] = x1;
+        command.f[3] = y1;
+    }
+    else
+    {
+        rasterizer.DrawLineAA(x0, y0, x1, y1, ToTargetColor(color));
+    }
+    // Coverage spreads one pixel either side of the line.
+    int left = (int)floorf(min(x0, x1)) - 1;
+    int top = (int)floorf(min(y0, y1)) - 1;
+    MarkDirty((IntRect){left, top, (int)ceilf(max(x0, x1)) + 2 - left, (int)ceilf(max(y0, y1)) + 2 - top});
+}
+
+void Display::DrawCircleAA(int x, int y, int r, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->drawCircle(x, y, r, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_CIRCLE_AA, ToTargetColor(color), {x, y, r});
+    }
+    else
+    {
+        rasterizer.DrawCircleAA(x, y, r, ToTargetColor(color));
+    }
+    MarkDirty((IntRect){x - r - 1, y - r - 1, (2 * r) + 3, (2 * r) + 3});
+}
+
+void Display::DrawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->drawTriangle(x0, y0, x1, y1, x2, y2, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_TRIANGLE, ToTargetColor(color), {x0, y0, x1, y1, x2, y2});
+    }
+    else
+    {
+        rasterizer.DrawTriangle(x0, y0, x1, y1, x2, y2, ToTargetColor(color));
+    }
+    int minX = min(x0, min(x1, x2));
+    int minY = min(y0, min(y1, y2));
+    MarkDirty((IntRect){minX, minY, max(x0, max(x1, x2)) - minX + 1, max(y0, max(y1, y2)) - minY + 1});
+}
+
+void Display::FillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        GetTFT()->fillTriangle(x0, y0, x1, y1, x2, y2, color);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        Record(DRAWCOMMAND_FILL_TRIANGLE, ToTargetColor(color), {x0, y0, x1, y1, x2, y2});
+    }
+    else
+    {
+        rasterizer.FillTriangle(x0, y0, x1, y1, x2, y2, ToTargetColor(color));
+    }
+    int minX = min(x0, min(x1, x2));
+    int minY = min(y0, min(y1, y2));
+    MarkDirty((IntRect){minX, minY, max(x0, max(x1, x2)) - minX + 1, max(y0, max(y1, y2)) - minY + 1});
+}
+
+void Display::DrawText(const BakedFont* font, const char* text, int x, int y, uint16_t fg, uint16_t bg)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        uint16_t palette[16];
+        int levels = (1 << font->bpp) - 1;
+        for (int i = 1; i <= levels; i++)
+        {
+            palette[i] = Blend565(bg, fg, ((i * 32) + (levels / 2)) / levels);
+        }
+        TFT_eSPI* tft = GetTFT();
+        Rasterizer::ScanText(font, text, x, y, (IntRect){0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT}, [&] (int x, int y, int w, uint8_t level) {
+            tft->drawFastHLine(x, y, w, palette[level]);
+        });
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        DrawCommand& command = Record(DRAWCOMMAND_TEXT, ToTargetColor(fg), {x, y});
+        command.bg = ToTargetColor(bg);
+        command.source = font;
+        command.offset = textPool.size();
+        textPool.insert(textPool.end(), text, text + strlen(text) + 1);
+    }
+    else
+    {
+        rasterizer.DrawText(font, text, x, y, ToTargetColor(fg), ToTargetColor(bg));
+    }
+    // Glyphs can overhang their advance and line slightly, so allow a margin of half a line around the text.
+    int margin = font->height / 2;
+    MarkDirty((IntRect){x - margin, y - margin, font->GetTextWidth(text) + (margin * 2), font->height + (margin * 2)});
+}
+
+void Display::DrawImage(const PackedImage* image, int x, int y)
+{
+    // Rows are decoded from the top, so those above the screen are decoded and skipped.
+    int startX = max(x, 0);
+    int endX = min(x + (int)image->w, DISPLAY_WIDTH);
+    int endY = min(y + (int)image->h, DISPLAY_HEIGHT);
+    if (startX >= endX || y >= endY)
+    {
+        return;
+    }
+
+    if (backend == RENDERBACKEND_TFT)
+    {
+        imageDecoder.Begin(image);
+        TFT_eSPI* tft = GetTFT();
+        tft->startWrite();
+        // Decoded rows are RGB565 in native byte order.
+        bool swapBytes = tft->getSwapBytes();
+        tft->setSwapBytes(true);
+        int top = max(y, 0);
+        tft->setAddrWindow(startX, top, endX - startX, endY - top);
+        for (int j = y; j < endY; j++)
+        {
+            const uint16_t* pixels = imageDecoder.NextRow();
+            if (pixels == nullptr)
+            {
+                break;
+            }
+            if (j >= 0)
+            {
+                tft->pushPixels(pixels + (startX - x), endX - startX);
+            }
+        }
+        tft->setSwapBytes(swapBytes);
+        tft->endWrite();
+        return;
+    }
+
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        DrawCommand& command = Record(DRAWCOMMAND_IMAGE, 0, {x, y});
+        command.source = image;
+    }
+    else
+    {
+        DrawImageRows(image, x, y);
+    }
+    MarkDirty((IntRect){x, y, (int)image->w, (int)image->h});
+}
+
+void Display::DrawImageRows(const PackedImage* image, int x, int y)
+{
+    BaseSurface* target = rasterizer.GetTarget();
+    int depth = GetDepth((PixelFormat)target->GetFormat());
+    int startX = max(x, 0);
+    int endX = min(x + (int)image->w, (int)target->GetWidth());
+    int endY = min(y + (int)image->h, (int)target->GetHeight());
+    if (startX >= endX || y >= endY)
+    {
+        return;
+    }
+
+    imageDecoder.Begin(image);
+    for (int j = y; j < endY; j++)
+    {
+        const uint16_t* pixels = imageDecoder.NextRow();
+        if (pixels == nullptr)
+        {
+            break;
+        }
+        if (j >= 0)
+        {
+            uint8_t* out = (uint8_t*)target->GetPixels() + (j * target->GetPitch()) + (startX * depth);
+            ConvertPixels(PF_RGB565, pixels + (startX - x), target->GetFormat(), out, endX - startX);
+        }
+    }
+}
+
+void Display::Blit(BaseSurface* src, IntRect* destRect, IntRect* srcRect)
+{
+    if (backend == RENDERBACKEND_TFT)
+    {
+        if (src->GetFormat() != PF_RGB565 && src->GetFormat() != PF_RGB565_BE)
+        {
+            return;
+        }
+        // Big-endian pixels are already in the order the panel expects.
+        bool swap = src->GetFormat() == PF_RGB565;
+        IntRect area = srcRect != nullptr ? *srcRect : (IntRect){0, 0, (int)src->GetWidth(), (int)src->GetHeight()};
+        int x = destRect != nullptr ? destRect->x : 0;
+        int y = destRect != nullptr ? destRect->y : 0;
+        // Clip the source area to the surface, moving the destination along with it.
+        int startX = max(area.x, 0);
+        int startY = max(area.y, 0);
+        int endX = min(area.x + area.w, (int)src->GetWidth());
+        int endY = min(area.y + area.h, (int)src->GetHeight());
+        if (startX >= endX || startY >= endY)
+        {
+            return;
+        }
+        x += startX - area.x;
+        y += startY - area.y;
+        area = {startX, startY, endX - startX, endY - startY};
+        uint8_t* pixels = (uint8_t*)src->GetPixels() + (area.y * src->GetPitch()) + (area.x * 2);
+        TFT_eSPI* tft = GetTFT();
+        bool swapBytes = tft->getSwapBytes();
+        tft->setSwapBytes(swap);
+        if (area.w * 2 == (int)src->GetPitch())
+        {
+            // Rows are contiguous, so push them all at once.
+            tft->pushImage(x, y, area.w, area.h, (uint16_t*)pixels);
+        }
+        else
+        {
+            for (int i = 0; i < area.h; i++)
+            {
+                tft->pushImage(x, y + i, area.w, 1, (uint16_t*)(pixels + (i * src->GetPitch())));
+            }
+        }
+        tft->setSwapBytes(swapBytes);
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        // The surface may change or be freed before the present, e.g. a glyph evicted from the cache by the next one,
+        // so the area drawn is copied now. Only the part within the surface is kept; the rest is clipped away anyway.
+        IntRect area = srcRect != nullptr ? *srcRect : (IntRect){0, 0, (int)src->GetWidth(), (int)src->GetHeight()};
+        int startX = max(area.x, 0);
+        int startY = max(area.y, 0);
+        int endX = min(area.x + area.w, (int)src->GetWidth());
+        int endY = min(area.y + area.h, (int)src->GetHeight());
+        if (startX >= endX || startY >= endY)
+        {
+            return;
+        }
+        IntRect kept = {startX, startY, endX - startX, endY - startY};
+
+        Surface* copy = new Surface();
+        copy->Init(kept.w, kept.h, src->GetFormat());
+        if (copy->GetPixels() == nullptr)
+        {
+            LogError("Failed to copy a surface to draw in strips!");
+            delete copy;
+            return;
+        }
+        if (IsIndexed(src->GetFormat()))
+        {
+            copy->SetPalette(src->GetPalette(), src->GetPaletteSize());
+        }
+        // Surfaces of the same format are copied as they are, blending only happens when replayed.
+        src->Blit(copy, nullptr, &kept);
+        copy->SetScaleMode(src->GetScaleMode());
+        copy->SetBlendMode(src->GetBlendMode());
+        blitSurfaces.push_back(copy);
+
+        DrawCommand& command = Record(DRAWCOMMAND_BLIT, 0, {0, 0, 0, 0, area.x - kept.x, area.y - kept.y, area.w, area.h});
+        command.source = copy;
+        command.hasDest = destRect != nullptr;
+        if (command.hasDest)
+        {
+            memcpy(command.i, destRect, sizeof(IntRect));
+        }
+    }
+    else
+    {
+        src->Blit(rasterizer.GetTarget(), destRect, srcRect);
+    }
+    if (destRect != nullptr)
+    {
+        MarkDirty(*destRect);
+    }
+    else
+    {
+        MarkDirty((IntRect){0, 0, srcRect != nullptr ? srcRect->w : (int)src->GetWidth(), srcRect != nullptr ? srcRect->h : (int)src->GetHeight()});
+    }
+}
+
+void Display::FillPolygon(const Point* vertices, int count, uint16_t color)
+{
+    if (count < 3)
+    {
+        return;
+    }
+    if (backend == RENDERBACKEND_TFT)
+    {
+        TFT_eSPI* tft = GetTFT();
+        rasterizer.ScanPolygon(vertices, count, (IntRect){0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT}, [&] (int x, int y, int w) {
+            tft->drawFastHLine(x, y, w, color);
+        });
+        return;
+    }
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        DrawCommand& command = Record(DRAWCOMMAND_POLYGON, ToTargetColor(color));
+        command.offset = vertexPool.size();
+        command.count = count;
+        vertexPool.insert(vertexPool.end(), vertices, vertices + count);
+    }
+    else
+    {
+        rasterizer.FillPolygon(vertices, count, ToTargetColor(color));
+    }
+
+    Vector2 lower = vertices[0];
+    Vector2 upper = vertices[0];
+    for (int i = 1; i < count; i++)
+    {
+        lower = lower.Min(vertices[i]);
+        upper = upper.Max(vertices[i]);
+    }
+    MarkDirty((IntRect){(int)floorf(lower.x), (int)floorf(lower.y), (int)ceilf(upper.x - floorf(lower.x)) + 1, (int)ceilf(upper.y - floorf(lower.y)) + 1});
+}
+
+void Display::SetDamageTracking(bool enable)
+{
+    if (enable && !damageTracking)
+    {
+        // The panel may not match the buffer yet.
+        MarkAllDirty();
+    }
+    damageTracking = enable;
+}
+
+bool Display::IsDamageTracking()
+{
+    return damageTracking;
+}
+
+void Display::MarkDirty(IntRect area)
+{
+    if (layer != nullptr)
+    {
+        layer->MarkChanged(area);
+        return;
+    }
+    int startX = max(area.x, 0) / DISPLAY_TILE_SIZE;
+    int startY = max(area.y, 0) / DISPLAY_TILE_SIZE;
+    int endX = min(area.x + area.w, DISPLAY_WIDTH);
+    int endY = min(area.y + area.h, DISPLAY_HEIGHT);
+    if (area.w <= 0 || area.h <= 0 || endX <= 0 || endY <= 0)
+    {
+        return;
+    }
+    endX = (endX - 1) / DISPLAY_TILE_SIZE;
+    endY = (endY - 1) / DISPLAY_TILE_SIZE;
+
+    for (int y = startY; y <= endY; y++)
+    {
+        for (int x = startX; x <= endX; x++)
+        {
+            touched[(y * DISPLAY_TILES_X) + x] = true;
+        }
+    }
+}
+
+void Display::MarkAllDirty()
+{
+    if (layer != nullptr)
+    {
+        layer->MarkAllChanged();
+        return;
+    }
+    memset(touched, true, sizeof(touched));
+}
+
+uint32_t Display::ToTargetColor(uint16_t color)
+{
+    return rasterizer.GetTarget()->GetFormat() == PF_RGB565_BE ? Swap565(color) : color;
 }
 
 void Display::SetDrawColor(uint16_t color)
@@ -107,20 +754,190 @@ uint16_t Display::GetDrawColor()
 
 void Display::RenderPresent()
 {
+    // The previous frame must finish sending before its buffer can be reused.
+    WaitPresent();
+
+    if (backend == RENDERBACKEND_STRIPS)
+    {
+        PresentStrips();
+        return;
+    }
+
+    if (damageTracking)
+    {
+        PresentDirtyTiles();
+        return;
+    }
+
+    // Whole frame pushes assume an unscrolled panel and a 16-bit buffer, otherwise send it in rows that follow the
+    // scroll and are expanded from the palette.
+    if (scroll != 0 || IsIndexed(renderBuffer.GetFormat()))
+    {
+        PushArea((IntRect){0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT});
+        return;
+    }
+
 #ifdef RENDER_DMA
-    device->tft->pushImageDMA(0, 0, 240, 240, (uint16_t*)renderBuffer.GetPixels(), (uint16_t*)dmaBuffer.GetPixels());
-#else
+    if (dmaBuffer.GetPixels() != nullptr)
+    {
+        // Flip buffers and start sending the finished frame.
+        renderBuffer.Swap(&dmaBuffer);
+
+        TFT_eSPI* tft = device->tft;
+        tft->startWrite();
+        // When swapping bytes, TFT_eSPI swaps the whole frame in place before sending; big-endian frames are sent as they are.
+        bool swapped = dmaBuffer.GetFormat() == PF_RGB565;
+        bool swapBytes = tft->getSwapBytes();
+        tft->setSwapBytes(swapped);
+        tft->pushImageDMA(0, 0, dmaBuffer.GetWidth(), dmaBuffer.GetHeight(), (uint16_t*)dmaBuffer.GetPixels());
+        tft->setSwapBytes(swapBytes);
+        presenting = true;
+
+        // Carry the frame over while it's sent so apps can keep drawing incrementally; the transfer only reads it.
+        // A frame swapped in place for sending is swapped back in the same pass as the copy.
+        if (swapped)
+        {
+            ConvertPixels(PF_RGB565_BE, dmaBuffer.GetPixels(), PF_RGB565, renderBuffer.GetPixels(), dmaBuffer.GetWidth() * dmaBuffer.GetHeight());
+        }
+        else
+        {
+            renderBuffer.Replicate(&dmaBuffer);
+        }
+        return;
+    }
+#endif // RENDER_DMA
+
 #ifdef OPTIMISED_RENDERING
-    tftspi->drawImage(0, 0, renderBuffer.GetWidth(), renderBuffer.GetHeight(), (uint16_t*)renderBuffer.GetPixels());
+    if (renderBuffer.GetFormat() == PF_RGB565_BE)
+    {
+        tftspi->drawImageRaw(0, 0, renderBuffer.GetWidth(), renderBuffer.GetHeight(), (uint16_t*)renderBuffer.GetPixels());
+    }
+    else
+    {
+        tftspi->drawImage(0, 0, renderBuffer.GetWidth(), renderBuffer.GetHeight(), (uint16_t*)renderBuffer.GetPixels());
+    }
 #else
-    device->tft->pushRect(0, 0, renderBuffer.GetWidth(), renderBuffer.GetHeight(), (uint16_t*)renderBuffer.GetPixels());
+    TFT_eSPI* tft = device->tft;
+    bool swapBytes = tft->getSwapBytes();
+    tft->setSwapBytes(renderBuffer.GetFormat() == PF_RGB565);
+    tft->pushRect(0, 0, renderBuffer.GetWidth(), renderBuffer.GetHeight(), (uint16_t*)renderBuffer.GetPixels());
+    tft->setSwapBytes(swapBytes);
 #endif // OPTIMISED_RENDERING
+}
+
+void Display::WaitPresent()
+{
+#ifdef RENDER_DMA
+    if (presenting)
+    {
+        device->tft->dmaWait();
+        device->tft->endWrite();
+        presenting = false;
+    }
 #endif // RENDER_DMA
+}
+
+bool Display::IsPresenting()
+{
+#ifdef RENDER_DMA
+    return presenting && device->tft->dmaBusy();
+#else
+    return false;
+#endif // RENDER_DMA
+}
+
+void Display::PresentDirtyTiles()
+{
+    WaitPresent();
+    for (int y = 0; y < DISPLAY_TILES_Y; y++)
+    {
+        bool* row = &touched[y * DISPLAY_TILES_X];
+        int x = 0;
+        while (x < DISPLAY_TILES_X)
+        {
+            if (!row[x])
+            {
+                x++;
+                continue;
+            }
 
+            // Merge the run of dirty tiles into one window.
+            int start = x;
+            while (x < DISPLAY_TILES_X && row[x])
+            {
+                row[x] = false;
+                x++;
+            }
+            PushArea((IntRect){start * DISPLAY_TILE_SIZE, y * DISPLAY_TILE_SIZE, (x - start) * DISPLAY_TILE_SIZE, DISPLAY_TILE_SIZE});
+        }
+    }
+}
+
+void Display::PushArea(IntRect area)
+{
+    // While scrolled, screen rows start part way into panel memory and wrap around its end.
+    int row = (area.y + scroll) % DISPLAY_VRAM_HEIGHT;
+    int split = DISPLAY_VRAM_HEIGHT - row;
+    if (area.h > split)
+    {
+        PushRows((IntRect){area.x, area.y, area.w, split}, row);
+        PushRows((IntRect){area.x, area.y + split, area.w, area.h - split}, 0);
+        return;
+    }
+    PushRows(area, row);
+}
+
+void Display::PushRows(IntRect area, int row)
+{
+    // Indexed buffers are expanded through the palette a line at a time as they're sent.
+    uint16_t format = renderBuffer.GetFormat();
+    bool indexed = IsIndexed(format);
+    auto getRow = [&] (int y) {
+        if (indexed)
+        {
+            renderBuffer.ExpandIndexed(area.x, y, area.w, line);
+            return line;
+        }
+        return (uint16_t*)((uint8_t*)renderBuffer.GetPixels() + (y * renderBuffer.GetPitch())) + area.x;
+    };
+
+#ifdef OPTIMISED_RENDERING
+    // The fast driver only takes contiguous images, so full width areas go in one window and others a row at a time.
+    // Big-endian pixels are sent without swapping.
+    bool contiguous = !indexed && area.w == DISPLAY_WIDTH;
+    for (int i = 0; i < area.h; i += contiguous ? area.h : 1)
+    {
+        int h = contiguous ? area.h : 1;
+        uint16_t* pixels = getRow(area.y + i);
+        if (format == PF_RGB565_BE)
+        {
+            tftspi->drawImageRaw(area.x, row + i, area.w, h, pixels);
+        }
+        else
+        {
+            tftspi->drawImage(area.x, row + i, area.w, h, pixels);
+        }
+    }
+#else
+    TFT_eSPI* tft = device->tft;
+    tft->startWrite();
+    // Big-endian rows are already in the order the panel expects.
+    bool swapBytes = tft->getSwapBytes();
+    tft->setSwapBytes(format != PF_RGB565_BE);
+    tft->setAddrWindow(area.x, row, area.w, area.h);
+    for (int i = 0; i < area.h; i++)
+    {
+        tft->pushPixels(getRow(area.y + i), area.w);
+    }
+    tft->setSwapBytes(swapBytes);
+    tft->endWrite();
+#endif // OPTIMISED_RENDERING
 }
 
 TFT_eSPI* Display::GetTFT()
 {
+    // A RENDER_DMA present holds the bus until it has been sent.
+    WaitPresent();
     return device->tft;
 }
 
@@ -128,3 +945,383 @@ Surface* Display::GetBuffer()
 {
     return &renderBuffer;
 }
+
+bool Display::SetBufferFormat(uint16_t format)
+{
+    if (format == renderBuffer.GetFormat())
+    {
+        return true;
+    }
+    if (format != PF_RGB565 && format != PF_RGB565_BE && !IsIndexed(format))
+    {
+        return false;
+    }
+
+    // Recorded colors are in the old format.
+    ForgetCommands();
+    return AllocateBuffers(format, renderBuffer.GetHeight());
+}
+
+bool Display::AllocateBuffers(uint16_t format, int height)
+{
+    WaitPresent();
+    // Keep the palette when only the size changes.
+    std::vector<uint16_t> palette;
+    if (IsIndexed(format) && format == renderBuffer.GetFormat())
+    {
+        palette.assign(renderBuffer.GetPalette(), renderBuffer.GetPalette() + renderBuffer.GetPaletteSize());
+    }
+
+    renderBuffer.Destroy();
+#ifdef RENDER_DMA
+    dmaBuffer.Destroy();
+#endif // RENDER_DMA
+
+    // Indexed buffers are never sent by DMA, they go through the line buffer.
+    uint8_t placement = IsIndexed(format) ? PLACEMENT_SRAM : DISPLAY_BUFFER_PLACEMENT;
+    renderBuffer.Init(DISPLAY_WIDTH, height, format, placement);
+    if (renderBuffer.GetPixels() == nullptr && placement == PLACEMENT_DMA)
+    {
+        // Internal memory may be too fragmented for one contiguous block, so settle for sending frames without DMA.
+        LogError("Failed to allocate the render buffer in DMA-capable memory, frames will be sent without DMA.");
+        placement = PLACEMENT_SRAM;
+        renderBuffer.Init(DISPLAY_WIDTH, height, format, placement);
+    }
+    bool success = renderBuffer.GetPixels() != nullptr;
+    if (!success && format != PF_RGB565)
+    {
+        LogError("Failed to change the render buffer format!");
+        format = PF_RGB565;
+        placement = PLACEMENT_SRAM;
+        renderBuffer.Init(DISPLAY_WIDTH, height, format, placement);
+    }
+    if (renderBuffer.GetPixels() == nullptr)
+    {
+        LogError("Failed to allocate the render buffer!");
+    }
+    else if (success && !palette.empty())
+    {
+        renderBuffer.SetPalette(palette.data(), palette.size());
+    }
+#ifdef RENDER_DMA
+    // The second buffer is only needed to send 16-bit frames in the background, and must match to swap with.
+    if (placement == PLACEMENT_DMA && renderBuffer.GetPixels() != nullptr)
+    {
+        dmaBuffer.Init(DISPLAY_WIDTH, height, format, PLACEMENT_DMA);
+        if (dmaBuffer.GetPixels() == nullptr)
+        {
+            LogError("Failed to allocate the DMA buffer, frames will be sent without DMA.");
+        }
+    }
+#endif // RENDER_DMA
+
+    if (layer == nullptr)
+    {
+        rasterizer.SetTarget(&renderBuffer);
+    }
+    memset(touched, true, sizeof(touched));
+    return success;
+}
+
+void Display::SetPalette(const uint16_t* colors, uint16_t count, uint16_t first)
+{
+    renderBuffer.SetPalette(colors, count, first);
+    // Every pixel may have changed color.
+    memset(touched, true, sizeof(touched));
+}
+
+IntRect Display::Scroll(int dy)
+{
+    if (dy == 0)
+    {
+        return (IntRect){0, 0, 0, 0};
+    }
+    if (abs(dy) >= DISPLAY_HEIGHT || (int)renderBuffer.GetHeight() < DISPLAY_HEIGHT)
+    {
+        // Nothing on screen survives, so there's no point scrolling. A strip has nothing to shift either.
+        MarkAllDirty();
+        return (IntRect){0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT};
+    }
+
+    // Don't change what the panel shows part way through a transfer.
+    WaitPresent();
+    if (!scrollArea)
+    {
+        // No fixed areas, all of panel memory scrolls.
+#ifdef OPTIMISED_RENDERING
+        tftspi->setScrollArea(0, 0);
+#else
+        TFT_eSPI* tft = device->tft;
+        tft->writecommand(0x33);
+        tft->writedata(0);
+        tft->writedata(0);
+        tft->writedata(DISPLAY_VRAM_HEIGHT >> 8);
+        tft->writedata(DISPLAY_VRAM_HEIGHT & 0xFF);
+        tft->writedata(0);
+        tft->writedata(0);
+#endif // OPTIMISED_RENDERING
+        scrollArea = true;
+    }
+    // Rows already in panel memory stay where they are; the screen just starts from a different row.
+    scroll = (((scroll - dy) % DISPLAY_VRAM_HEIGHT) + DISPLAY_VRAM_HEIGHT) % DISPLAY_VRAM_HEIGHT;
+    SendScrollOffset();
+
+    uint8_t* pixels = (uint8_t*)renderBuffer.GetPixels();
+    uint32_t pitch = renderBuffer.GetPitch();
+    int kept = DISPLAY_HEIGHT - abs(dy);
+    IntRect exposed;
+    if (dy > 0)
+    {
+        memmove(pixels + (dy * pitch), pixels, kept * pitch);
+        exposed = (IntRect){0, 0, DISPLAY_WIDTH, dy};
+    }
+    else
+    {
+        memmove(pixels, pixels + (-dy * pitch), kept * pitch);
+        exposed = (IntRect){0, kept, DISPLAY_WIDTH, -dy};
+    }
+
+    // Tiles that changed but haven't been sent yet have moved with the buffer.
+    bool moved[DISPLAY_TILES_X * DISPLAY_TILES_Y];
+    memcpy(moved, touched, sizeof(touched));
+    memset(touched, false, sizeof(touched));
+    for (int y = 0; y < DISPLAY_TILES_Y; y++)
+    {
+        for (int x = 0; x < DISPLAY_TILES_X; x++)
+        {
+            if (moved[(y * DISPLAY_TILES_X) + x])
+            {
+                MarkDirty((IntRect){x * DISPLAY_TILE_SIZE, (y * DISPLAY_TILE_SIZE) + dy, DISPLAY_TILE_SIZE, DISPLAY_TILE_SIZE});
+            }
+        }
+    }
+    MarkDirty(exposed);
+    return exposed;
+}
+
+int Display::GetScrollOffset()
+{
+    return scroll;
+}
+
+void Display::ResetScroll()
+{
+    if (scroll == 0)
+    {
+        return;
+    }
+    WaitPresent();
+    scroll = 0;
+    SendScrollOffset();
+    PushArea((IntRect){0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT});
+    memset(touched, false, sizeof(touched));
+}
+
+DrawCommand& Display::Record(uint8_t type, uint32_t color, std::initializer_list<int> args)
+{
+    commands.push_back(DrawCommand());
+    DrawCommand& command = commands.back();
+    command.type = type;
+    command.color = color;
+    int count = 0;
+    for (int arg : args)
+    {
+        command.i[count++] = arg;
+    }
+    return command;
+}
+
+void Display::ForgetCommands()
+{
+    commands.clear();
+    textPool.clear();
+    vertexPool.clear();
+    for (unsigned int i = 0, counti = blitSurfaces.size(); i < counti; i++)
+    {
+        blitSurfaces[i]->Destroy();
+        delete blitSurfaces[i];
+    }
+    blitSurfaces.clear();
+}
+
+void Display::Replay(const DrawCommand& command, int top)
+{
+    const int* i = command.i;
+    uint32_t color = command.color;
+    switch (command.type)
+    {
+    case DRAWCOMMAND_FILL_RECT:
+        rasterizer.FillRect((IntRect){i[0], i[1] - top, i[2], i[3]}, color);
+        break;
+    case DRAWCOMMAND_PIXEL:
+        rasterizer.DrawPixel(i[0], i[1] - top, color);
+        break;
+    case DRAWCOMMAND_HLINE:
+        rasterizer.DrawHLine(i[0], i[1] - top, i[2], color);
+        break;
+    case DRAWCOMMAND_VLINE:
+        rasterizer.DrawVLine(i[0], i[1] - top, i[2], color);
+        break;
+    case DRAWCOMMAND_LINE:
+        rasterizer.DrawLine(i[0], i[1] - top, i[2], i[3] - top, color);
+        break;
+    case DRAWCOMMAND_CIRCLE:
+        rasterizer.DrawCircle(i[0], i[1] - top, i[2], color);
+        break;
+    case DRAWCOMMAND_FILL_CIRCLE:
+        rasterizer.FillCircle(i[0], i[1] - top, i[2], color);
+        break;
+    case DRAWCOMMAND_LINE_AA:
+        rasterizer.DrawLineAA(command.f[0], command.f[1] - top, command.f[2], command.f[3] - top, color);
+        break;
+    case DRAWCOMMAND_CIRCLE_AA:
+        rasterizer.DrawCircleAA(i[0], i[1] - top, i[2], color);
+        break;
+    case DRAWCOMMAND_TRIANGLE:
+        rasterizer.DrawTriangle(i[0], i[1] - top, i[2], i[3] - top, i[4], i[5] - top, color);
+        break;
+    case DRAWCOMMAND_FILL_TRIANGLE:
+        rasterizer.FillTriangle(i[0], i[1] - top, i[2], i[3] - top, i[4], i[5] - top, color);
+        break;
+    case DRAWCOMMAND_POLYGON:
+        stripVertices.assign(vertexPool.begin() + command.offset, vertexPool.begin() + command.offset + command.count);
+        for (unsigned int j = 0, countj = stripVertices.size(); j < countj; j++)
+        {
+            stripVertices[j].y -= top;
+        }
+        rasterizer.FillPolygon(stripVertices.data(), command.count, color);
+        break;
+    case DRAWCOMMAND_TEXT:
+        rasterizer.DrawText((const BakedFont*)command.source, &textPool[command.offset], i[0], i[1] - top, color, command.bg);
+        break;
+    case DRAWCOMMAND_IMAGE:
+    {
+        // Only decode images that reach the band; rows above it still have to be decoded and skipped.
+        const PackedImage* image = (const PackedImage*)command.source;
+        if (i[1] - top < (int)renderBuffer.GetHeight() && i[1] - top + image->h > 0)
+        {
+            DrawImageRows(image, i[0], i[1] - top);
+        }
+        break;
+    }
+    case DRAWCOMMAND_BLIT:
+    {
+        BaseSurface* src = (BaseSurface*)command.source;
+        IntRect srcRect = {i[4], i[5], i[6], i[7]};
+        IntRect destRect = command.hasDest ? (IntRect){i[0], i[1], i[2], i[3]} : (IntRect){0, 0, srcRect.w, srcRect.h};
+        destRect.y -= top;
+        src->Blit(&renderBuffer, &destRect, &srcRect);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void Display::PresentStrips()
+{
+    // Each band is a row of tiles, and only those with a touched tile have been drawn into.
+    for (int y = 0; y < DISPLAY_TILES_Y; y++)
+    {
+        const bool* row = &touched[y * DISPLAY_TILES_X];
+        bool drawn = false;
+        for (int x = 0; x < DISPLAY_TILES_X && !drawn; x++)
+        {
+            drawn = row[x];
+        }
+        if (!drawn)
+        {
+            continue;
+        }
+
+        int top = y * DISPLAY_TILE_SIZE;
+        renderBuffer.Clear(0);
+        for (unsigned int i = 0, counti = commands.size(); i < counti; i++)
+        {
+            Replay(commands[i], top);
+        }
+        PushStrip(top, row);
+    }
+
+    ForgetCommands();
+    memset(touched, false, sizeof(touched));
+}
+
+void Display::PushStrip(int top, const bool* row)
+{
+#ifdef RENDER_DMA
+    bool whole = true;
+    for (int x = 0; x < DISPLAY_TILES_X && whole; x++)
+    {
+        whole = row[x];
+    }
+    if (whole && dmaBuffer.GetPixels() != nullptr)
+    {
+        // Wait for the previous band, then send this one while the next is rasterized into the other strip.
+        WaitPresent();
+        renderBuffer.Swap(&dmaBuffer);
+
+        TFT_eSPI* tft = device->tft;
+        tft->startWrite();
+        bool swapBytes = tft->getSwapBytes();
+        tft->setSwapBytes(dmaBuffer.GetFormat() == PF_RGB565);
+        tft->pushImageDMA(0, top, DISPLAY_WIDTH, DISPLAY_STRIP_HEIGHT, (uint16_t*)dmaBuffer.GetPixels());
+        tft->setSwapBytes(swapBytes);
+        presenting = true;
+        return;
+    }
+    // Runs of tiles aren't contiguous in the strip, so they're sent synchronously once the last band has gone.
+    WaitPresent();
+#endif // RENDER_DMA
+
+    // Untouched tiles weren't drawn, so only runs of touched tiles are sent, each as one window.
+    int x = 0;
+    while (x < DISPLAY_TILES_X)
+    {
+        if (!row[x])
+        {
+            x++;
+            continue;
+        }
+        int start = x;
+        while (x < DISPLAY_TILES_X && row[x])
+        {
+            x++;
+        }
+        PushRows((IntRect){start * DISPLAY_TILE_SIZE, 0, (x - start) * DISPLAY_TILE_SIZE, DISPLAY_STRIP_HEIGHT}, top);
+    }
+}
+
+void Display::SendScrollOffset()
+{
+#ifdef OPTIMISED_RENDERING
+    tftspi->setScroll(scroll);
+#else
+    TFT_eSPI* tft = device->tft;
+    tft->writecommand(0x37);
+    tft->writedata(scroll >> 8);
+    tft->writedata(scroll & 0xFF);
+#endif // OPTIMISED_RENDERING
+}
+
+void Display::BeginLayer(Layer* layer)
+{
+    if (this->layer == nullptr)
+    {
+        layerBackend = backend;
+    }
+    this->layer = layer;
+    // Layers are always drawn into by the rasterizer.
+    backend = RENDERBACKEND_BUFFER;
+    rasterizer.SetTarget(layer->GetSurface());
+}
+
+void Display::EndLayer()
+{
+    if (layer != nullptr)
+    {
+        layer = nullptr;
+        backend = layerBackend;
+        rasterizer.SetTarget(&renderBuffer);
+    }
+}
@@ -2,17 +2,121 @@
 #define DISPLAY_H
 
 #include <Arduino.h>
+#include <initializer_list>
+#include <vector>
 #include "color.h"
 #include "surface.h"
+#include "rasterizer.h"
+#include "glyphcache.h"
+#include "image.h"
+#include "layer.h"
 
+// Draws through Arduino_ST7789_Fast instead of TFT_eSPI, sending whole windows with bulk SPI writes on ESP32.
 //#define OPTIMISED_RENDERING
 
 #ifdef OPTIMISED_RENDERING
 #include "Arduino_ST7789_Fast.h"
 #endif // OPTIMISED_RENDERING
 
+// Send frames to the panel with DMA, drawing the next frame while the last is sent. The bus is held until the transfer
+// ends, so draw directly to the panel only through GetTFT(), which waits for it first; TTGOClass::tft doesn't.
 //#define RENDER_DMA
 
+#ifdef RENDER_DMA
+// The render buffer is swapped with the DMA buffer, so both go in internal memory that SPI DMA can read.
+// If the render buffer doesn't fit there, it falls back to PLACEMENT_SRAM and frames are sent without DMA.
+#define DISPLAY_BUFFER_PLACEMENT PLACEMENT_DMA
+#else
+#define DISPLAY_BUFFER_PLACEMENT PLACEMENT_SRAM
+#endif // RENDER_DMA
+
+// Start with damage tracking enabled, so RenderPresent() only sends the tiles that have changed, a window at a time.
+// Without it, each present sends the whole frame, which RENDER_DMA does in the background.
+//#define DISPLAY_DAMAGE_TRACKING
+
+// Start in the strip backend, so a full size render buffer is only allocated if an app switches to RENDERBACKEND_BUFFER.
+//#define RENDER_STRIPS
+
+// Dimensions of the display in pixels.
+#define DISPLAY_WIDTH 240
+#define DISPLAY_HEIGHT 240
+
+// Size of the square tiles used to track which parts of the render buffer have changed.
+#define DISPLAY_TILE_SIZE 24
+#define DISPLAY_TILES_X (DISPLAY_WIDTH / DISPLAY_TILE_SIZE)
+#define DISPLAY_TILES_Y (DISPLAY_HEIGHT / DISPLAY_TILE_SIZE)
+
+// Rows of frame memory in the panel. The screen shows DISPLAY_HEIGHT of them, starting from the scroll offset.
+#define DISPLAY_VRAM_HEIGHT 320
+
+// Rows in each band of the screen rasterized by the strip backend, one row of tiles so damage maps straight onto bands.
+#define DISPLAY_STRIP_HEIGHT DISPLAY_TILE_SIZE
+
+// Backlight level used while the display is in always-on mode.
+#define DISPLAY_ALWAYS_ON_BRIGHTNESS 24
+
+// Where the drawing methods of a Display end up.
+enum RenderBackend
+{
+    // Draw straight to the panel through TFT_eSPI.
+    RENDERBACKEND_TFT = 0,
+    // Rasterize into the render buffer, which is sent to the panel by RenderPresent().
+    RENDERBACKEND_BUFFER,
+    // Record drawing, then rasterize it into a small strip buffer a band at a time when RenderPresent() is called,
+    // instead of keeping a full size render buffer. Nothing is kept between frames: each tile that is drawn into is
+    // redrawn from black with everything recorded since the last present, and other tiles stay as they are on the panel.
+    // So a touched tile must be redrawn in full, e.g. by drawing everything that overlaps it again or by clearing it
+    // first, and anything left out turns black. Layers and scrolling need the buffer backend.
+    RENDERBACKEND_STRIPS
+};
+
+// Draw calls recorded by the strip backend.
+enum DrawCommandType
+{
+    DRAWCOMMAND_FILL_RECT = 0,
+    DRAWCOMMAND_PIXEL,
+    DRAWCOMMAND_HLINE,
+    DRAWCOMMAND_VLINE,
+    DRAWCOMMAND_LINE,
+    DRAWCOMMAND_CIRCLE,
+    DRAWCOMMAND_FILL_CIRCLE,
+    DRAWCOMMAND_LINE_AA,
+    DRAWCOMMAND_CIRCLE_AA,
+    DRAWCOMMAND_TRIANGLE,
+    DRAWCOMMAND_FILL_TRIANGLE,
+    DRAWCOMMAND_POLYGON,
+    DRAWCOMMAND_TEXT,
+    DRAWCOMMAND_IMAGE,
+    DRAWCOMMAND_BLIT
+};
+
+// A draw call recorded by the strip backend, replayed into each band of the screen when presented.
+struct DrawCommand
+{
+    uint8_t type;
+
+    // Colors, already converted to the format of the render buffer.
+    uint32_t color;
+    uint32_t bg;
+
+    // Coordinates and sizes in the order they were passed; rects take four each.
+    union
+    {
+        int i[8];
+        float f[4];
+    };
+
+    // Font or image drawn, or the copy of the surface area blitted.
+    const void* source;
+
+    // Start of the text or vertices in the display's pools, and how many vertices.
+    uint32_t offset;
+    uint32_t count;
+
+    // Whether a blit was passed a destination rect.
+    bool hasDest;
+};
+
 // Forward declarations
 class TTGOClass;
 class TFT_eSPI;
@@ -35,9 +139,76 @@ public:
 
     bool IsEnabled();
 
+    // Enters the low-power always-on mode, where only rows top to bottom (inclusive) are shown, in 8 colours,
+    // with the backlight dimmed. The panel keeps showing those rows without being sent anything, so draw into them
+    // at whatever rate is needed. Any other drawing is kept in panel memory but not shown until ExitAlwaysOn().
+    void EnterAlwaysOn(int top, int bottom);
+
+    // Shows the whole screen in full colour at the previous brightness again.
+    void ExitAlwaysOn();
+
+    // Is the display in always-on mode?
+    bool IsAlwaysOn();
+
+    // Set where drawing methods such as DrawLine() and Clear() draw to.
+    void SetRenderBackend(RenderBackend backend);
+
+    // Returns where drawing methods draw to.
+    RenderBackend GetRenderBackend();
+
+    // Returns the rasterizer that draws into the render buffer.
+    Rasterizer* GetRasterizer();
+
+    // Returns the cache of pre-rasterized glyphs used to draw text.
+    GlyphCache* GetGlyphCache();
+
     // Clears the current display with a given color.
     void Clear(uint16_t color);
 
+    // Fills an area with a given color.
+    void FillRect(IntRect area, uint16_t color);
+
+    // Primitive drawing methods, drawn using the current render backend.
+    void DrawPixel(int x, int y, uint16_t color);
+    void DrawHLine(int x, int y, int w, uint16_t color);
+    void DrawVLine(int x, int y, int h, uint16_t color);
+    void DrawLine(int x0, int y0, int x1, int y1, uint16_t color);
+    void DrawCircle(int x, int y, int r, uint16_t color);
+    void FillCircle(int x, int y, int r, uint16_t color);
+    void DrawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+    void FillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+    void FillPolygon(const Point* vertices, int count, uint16_t color);
+
+    // Anti-aliased drawing, blended into the render buffer. The TFT backend falls back to aliased drawing.
+    void DrawLineAA(float x0, float y0, float x1, float y1, uint16_t color);
+    void DrawCircleAA(int x, int y, int r, uint16_t color);
+
+    // Draws a string in a baked font with the top left at (x, y), mixing partial coverage between fg and bg.
+    void DrawText(const BakedFont* font, const char* text, int x, int y, uint16_t fg, uint16_t bg);
+
+    // Draws a packed image with the top left at (x, y), decoding it a row at a time.
+    // The TFT backend streams the rows straight to the panel, without the image ever being decoded in full.
+    void DrawImage(const PackedImage* image, int x, int y);
+
+    // Draws a surface into the render buffer, see BaseSurface::Blit().
+    // The TFT backend pushes RGB565 surfaces straight to the panel, without scaling or blending. Only the position of
+    // destRect is used there; its size is ignored and the source area is drawn at its own size.
+    // The strip backend copies the area drawn and blits the copy when presenting, so the surface is free to change.
+    void Blit(BaseSurface* src, IntRect* destRect = nullptr, IntRect* srcRect = nullptr);
+
+    // Enable or disable damage tracking. When enabled, RenderPresent() only sends tiles that have been marked dirty.
+    void SetDamageTracking(bool enable);
+
+    // Is damage tracking enabled?
+    bool IsDamageTracking();
+
+    // Marks the tiles overlapping an area of the render buffer as changed.
+    // Clear(), FillRect() and Blit() do this automatically; call it after drawing into GetBuffer() directly.
+    void MarkDirty(IntRect area);
+
+    // Marks the whole render buffer as changed.
+    void MarkAllDirty();
+
     // Set the default draw colour.
     void SetDrawColor(uint16_t color);
 
@@ -45,12 +216,57 @@ public:
     uint16_t GetDrawColor();
 
     // Draws the render buffer to the display.
+    // With RENDER_DMA, the finished frame is swapped out to the DMA buffer and sent in the background, so this returns
+    // once it has been copied back to draw the next frame over, while the transfer runs. TFT_eSPI byte swaps RGB565
+    // frames in place before sending them, which costs an extra pass that PF_RGB565_BE frames don't need.
     void RenderPresent();
 
-    // Returns the raw render buffer.
+    // Sends only the dirty tiles to the panel, merging horizontally adjacent tiles into a single window, whether or not
+    // damage tracking is enabled. Use this to send what has been drawn into the render buffer without overwriting
+    // anything drawn straight to the panel elsewhere.
+    void PresentDirtyTiles();
+
+    // Blocks until the last frame has been fully sent to the display. Returns immediately without RENDER_DMA.
+    void WaitPresent();
+
+    // Is a frame still being sent to the display?
+    bool IsPresenting();
+
+    // Returns the raw render buffer. With the strip backend, it only holds a band of the screen.
     Surface* GetBuffer();
 
-    // Returns a pointer to the TFT_eSPI instance.
+    // Reallocates the render buffer (or strip) in PF_RGB565, PF_RGB565_BE, PF_INDEX4 or PF_INDEX8.
+    // Big-endian buffers are sent without swapping bytes; drawing methods still take native RGB565 colors and swap them
+    // once per call. Indexed buffers fit flat colour screens in a quarter or half of the memory, are expanded through
+    // their palette a line at a time when presented, and drawing colors become palette indices. Layers, anti-aliasing
+    // and images need a 16-bit buffer.
+    // Returns false if the format isn't supported or can't be allocated, in which case the buffer is RGB565.
+    bool SetBufferFormat(uint16_t format);
+
+    // Sets colors of the render buffer palette and marks the whole buffer dirty, so recoloring costs one present.
+    void SetPalette(const uint16_t* colors, uint16_t count, uint16_t first = 0);
+
+    // Moves what is on screen by dy rows using the panel's vertical scrolling, where a positive dy moves it down.
+    // The render buffer is shifted to match and only the newly exposed rows are marked dirty, so with damage tracking
+    // RenderPresent() sends just those. Returns the exposed rows, which should be drawn before presenting.
+    // While scrolled, anything drawn with the TFT backend ignores the scroll and lands in the wrong rows.
+    // Call outside of BeginLayer() and EndLayer().
+    IntRect Scroll(int dy);
+
+    // Returns the row of panel memory shown at the top of the screen.
+    int GetScrollOffset();
+
+    // Scrolls the panel back to the start and sends the whole render buffer so the screen looks the same.
+    void ResetScroll();
+
+    // Redirects drawing methods into a layer until EndLayer() is called, marking the drawn areas of the layer as changed.
+    void BeginLayer(Layer* layer);
+
+    // Restores drawing to the render buffer or panel.
+    void EndLayer();
+
+    // Returns a pointer to the TFT_eSPI instance, after waiting for any present still being sent, see WaitPresent().
+    // Draw to the panel through this rather than keeping the pointer around, so drawing never meets a DMA transfer.
     TFT_eSPI* GetTFT();
 
     // Returns how long since the display has been enabled. Returns 0 if the display is disabled.
@@ -66,19 +282,98 @@ private:
     // The buffer used for rendering.
     Surface renderBuffer;
 
-    // TODO: tiles for optimised rendering
-    // 100 24x24 tiles to break up the data sent to the screen, for efficiency.
-    Surface tiles[10 * 10];
+    // Draws shapes into the render buffer.
+    Rasterizer rasterizer;
+
+    // Pre-rasterized glyphs for drawing text.
+    GlyphCache glyphCache;
+
+    // Decodes packed images for DrawImage().
+    PackedImageDecoder imageDecoder;
+
+    // Where drawing methods draw to.
+    uint8_t backend = RENDERBACKEND_TFT;
+
+    // The layer being drawn into, if any.
+    Layer* layer = nullptr;
+
+    // Backend to restore when the layer is finished.
+    uint8_t layerBackend = RENDERBACKEND_TFT;
+
+    // Sends an area of the render buffer to the panel.
+    void PushArea(IntRect area);
+
+    // Reallocates the render buffer, and the DMA buffer, with a given format and height.
+    // Returns false if the format couldn't be allocated, in which case the buffers are RGB565.
+    bool AllocateBuffers(uint16_t format, int height);
+
+    // Decodes a packed image straight into the rasterizer target, clipped to the target.
+    void DrawImageRows(const PackedImage* image, int x, int y);
 
-    // Which tiles have been touched?
-    bool touched[10 * 10];
+    // Adds a draw call for the strip backend to replay.
+    DrawCommand& Record(uint8_t type, uint32_t color, std::initializer_list<int> args = {});
+
+    // Forgets the draw calls recorded by the strip backend, freeing copies of blitted surfaces.
+    void ForgetCommands();
+
+    // Rasterizes a recorded draw call into the strip holding the band of rows from top.
+    void Replay(const DrawCommand& command, int top);
+
+    // Rasterizes and sends each band of the screen that has been drawn into, then forgets what was recorded.
+    void PresentStrips();
+
+    // Sends the touched tiles in a row of them from the strip to the panel, starting at row top of the screen.
+    // With RENDER_DMA, fully touched 16-bit strips are sent in the background from the DMA buffer while the next band
+    // is rasterized.
+    void PushStrip(int top, const bool* row);
+
+    // Converts a native RGB565 color to the format drawn into, once per draw rather than per pixel.
+    uint32_t ToTargetColor(uint16_t color);
+
+    // Sends an area of the render buffer to the panel, starting at a given row of panel memory.
+    void PushRows(IntRect area, int row);
+
+    // Tells the panel which row of its memory to show at the top of the screen.
+    void SendScrollOffset();
+
+    // Draw calls recorded by the strip backend since the last present.
+    std::vector<DrawCommand> commands;
+
+    // Text and polygon vertices of the recorded draw calls.
+    std::vector<char> textPool;
+    std::vector<Point> vertexPool;
+
+    // Copies of the surface areas blitted by the recorded draw calls.
+    std::vector<Surface*> blitSurfaces;
+
+    // Polygon vertices moved into the band being rasterized.
+    std::vector<Point> stripVertices;
+
+    // RGB565 pixels of an indexed render buffer row being sent.
+    uint16_t line[DISPLAY_WIDTH];
+
+    // Which tiles have been touched since the last present?
+    bool touched[DISPLAY_TILES_X * DISPLAY_TILES_Y] = { false };
+
+    // Whether only touched tiles are presented.
+    bool damageTracking = false;
+
+    // Row of panel memory shown at the top of the screen.
+    int scroll = 0;
+
+    // Whether the whole of panel memory has been set up to scroll.
+    bool scrollArea = false;
 
     // Default color
     uint16_t drawColor = TFT_BLACK;
 
 #ifdef RENDER_DMA
-    // The extra buffer used for DMA rendering
+    // The extra buffer used for DMA rendering, holds the frame (or band) being sent while the next is drawn into renderBuffer.
+    // Not allocated for indexed buffers, or if either buffer didn't fit in DMA-capable memory, so frames are sent without DMA.
     Surface dmaBuffer;
+
+    // Whether a DMA transfer has been started and not yet waited on.
+    bool presenting = false;
 #endif // RENDER_DMA
 
 #ifdef OPTIMISED_RENDERING
@@ -89,6 +384,12 @@ private:
     // Whether the display is enabled
     bool enabled = false;
 
+    // Whether the display is in always-on mode.
+    bool alwaysOn = false;
+
+    // Brightness to restore when leaving always-on mode.
+    uint8_t alwaysOnBrightness = 0;
+
     // How bright the display is
     uint8_t brightness;
 
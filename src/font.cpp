@@ -0,0 +1,61 @@
+#include "font.h"
+
+const BakedGlyph* BakedFont::GetGlyph(uint16_t codepoint) const
+{
+    if (codepoint < first || codepoint >= first + count)
+    {
+        return nullptr;
+    }
+    return &glyphs[codepoint - first];
+}
+
+int BakedFont::GetKerning(uint16_t left, uint16_t right) const
+{
+    // Binary search, as pairs are sorted.
+    int low = 0;
+    int high = (int)kerningCount - 1;
+    uint32_t key = ((uint32_t)left << 16) | right;
+    while (low <= high)
+    {
+        int mid = (low + high) / 2;
+        uint32_t pair = ((uint32_t)kerning[mid].left << 16) | kerning[mid].right;
+        if (pair == key)
+        {
+            return kerning[mid].adjust;
+        }
+        else if (pair < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+    return 0;
+}
+
+int BakedFont::GetRowBytes(const BakedGlyph* glyph) const
+{
+    return ((glyph->w * bpp) + 7) / 8;
+}
+
+int BakedFont::GetTextWidth(const char* text) const
+{
+    int width = 0;
+    uint16_t previous = 0;
+    for (const char* c = text; *c != '\0'; c++)
+    {
+        uint16_t codepoint = (uint8_t)*c;
+        const BakedGlyph* glyph = GetGlyph(codepoint);
+        if (glyph == nullptr)
+        {
+            // Missing glyphs are skipped without kerning either side, as Rasterizer::ScanText() draws them.
+            previous = 0;
+            continue;
+        }
+        width += glyph->advance + (previous != 0 ? GetKerning(previous, codepoint) : 0);
+        previous = codepoint;
+    }
+    return width;
+}
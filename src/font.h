@@ -0,0 +1,63 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+
+/// A glyph within a baked font. Bitmaps are cropped to the visible pixels of the glyph.
+struct BakedGlyph
+{
+    /// Offset of the glyph bitmap within BakedFont::bitmaps.
+    uint32_t offset;
+    /// Size of the glyph bitmap in pixels.
+    uint8_t w;
+    uint8_t h;
+    /// Position of the glyph bitmap relative to the pen, where y is measured down from the top of the line.
+    int8_t x;
+    int8_t y;
+    /// Horizontal distance from this pen position to the next.
+    uint8_t advance;
+};
+
+/// Adjusts the advance between a specific pair of characters.
+struct BakedKerning
+{
+    uint16_t left;
+    uint16_t right;
+    int8_t adjust;
+};
+
+/// A bitmap font baked at build time by tools/bakefont.py into constexpr tables, which are kept in flash.
+/// Glyph rows are packed at 1, 2 or 4 bits per pixel, most significant bits first, with each row starting on a byte boundary.
+struct BakedFont
+{
+    /// Packed glyph bitmaps.
+    const uint8_t* bitmaps;
+    /// Glyphs for each codepoint from first to first + count - 1.
+    const BakedGlyph* glyphs;
+    /// Kerning pairs sorted by left then right codepoint, may be nullptr.
+    const BakedKerning* kerning;
+    uint16_t first;
+    uint16_t count;
+    uint16_t kerningCount;
+    /// Bits per pixel of the glyph bitmaps.
+    uint8_t bpp;
+    /// Distance between lines of text.
+    uint8_t height;
+    /// Distance from the top of a line to the baseline.
+    uint8_t baseline;
+
+    /// Returns the glyph for a codepoint, or nullptr if the font doesn't have it.
+    const BakedGlyph* GetGlyph(uint16_t codepoint) const;
+
+    /// Returns the adjustment to the advance between a pair of codepoints.
+    int GetKerning(uint16_t left, uint16_t right) const;
+
+    /// Returns the number of bytes in each row of a glyph bitmap.
+    int GetRowBytes(const BakedGlyph* glyph) const;
+
+    /// Returns the width of a string in pixels, including kerning.
+    int GetTextWidth(const char* text) const;
+
+};
+
+#endif // FONT_H
@@ -0,0 +1,149 @@
+#include "config.h"
+
+#include "glyphcache.h"
+
+void GlyphCache::Init(TFT_eSPI* tft)
+{
+    this->tft = tft;
+    budget = psramFound() ? GLYPHCACHE_BUDGET_PSRAM : GLYPHCACHE_BUDGET_SRAM;
+}
+
+void GlyphCache::Destroy()
+{
+    Clear();
+}
+
+Surface* GlyphCache::Get(uint8_t font, uint8_t size, uint16_t codepoint, uint16_t fg, uint16_t bg)
+{
+    uint64_t key = ((uint64_t)font << 56) | ((uint64_t)size << 48) | ((uint64_t)codepoint << 32) | ((uint32_t)fg << 16) | bg;
+
+    auto itr = lookup.find(key);
+    if (itr != lookup.end())
+    {
+        hits++;
+        // Move to the front, as the most recently used.
+        entries.splice(entries.begin(), entries, itr->second);
+        return &itr->second->glyph;
+    }
+
+    misses++;
+    // Surfaces can't be copied, so the glyph is rasterized in place.
+    entries.emplace_front();
+    Entry& entry = entries.front();
+    entry.key = key;
+    if (!Rasterize(&entry.glyph, font, size, codepoint, fg, bg))
+    {
+        entries.pop_front();
+        return nullptr;
+    }
+
+    // Make room for the new glyph. A glyph larger than the whole budget is still returned, but only kept until the next call.
+    uint32_t bytes = entry.glyph.GetPitch() * entry.glyph.GetHeight();
+    Evict(budget > bytes ? budget - bytes : 0);
+
+    lookup[key] = entries.begin();
+    memoryUsed += bytes;
+    return &entry.glyph;
+}
+
+bool GlyphCache::Rasterize(Surface* glyph, uint8_t font, uint8_t size, uint16_t codepoint, uint16_t fg, uint16_t bg)
+{
+    TFT_eSprite sprite(tft);
+    sprite.setColorDepth(16);
+    sprite.setTextFont(font);
+    sprite.setTextSize(size);
+
+    char text[2] = { (char)codepoint, '\0' };
+    int16_t w = sprite.textWidth(text, font);
+    int16_t h = sprite.fontHeight(font);
+    if (w <= 0 || h <= 0 || sprite.createSprite(w, h) == nullptr)
+    {
+        return false;
+    }
+
+    sprite.fillSprite(bg);
+    sprite.setTextColor(fg, bg);
+    sprite.drawChar(codepoint, 0, 0, font);
+
+    glyph->Init(w, h, PF_RGB565, PLACEMENT_PSRAM);
+    if (glyph->GetPixels() == nullptr)
+    {
+        sprite.deleteSprite();
+        return false;
+    }
+
+    // Sprites hold pixels with the high byte first, ready to send to the panel; surfaces are in native byte order.
+    uint16_t* src = (uint16_t*)sprite.getPointer();
+    for (int y = 0; y < h; y++)
+    {
+        uint16_t* dest = (uint16_t*)((uint8_t*)glyph->GetPixels() + (y * glyph->GetPitch()));
+        for (int x = 0; x < w; x++)
+        {
+            uint16_t pixel = *src++;
+            dest[x] = (pixel >> 8) | (pixel << 8);
+        }
+    }
+
+    sprite.deleteSprite();
+    return true;
+}
+
+void GlyphCache::Evict(uint32_t limit)
+{
+    while (memoryUsed > limit && !entries.empty())
+    {
+        Entry& entry = entries.back();
+        memoryUsed -= entry.glyph.GetPitch() * entry.glyph.GetHeight();
+        entry.glyph.Destroy();
+        lookup.erase(entry.key);
+        entries.pop_back();
+    }
+}
+
+void GlyphCache::Clear()
+{
+    Evict(0);
+}
+
+void GlyphCache::SetBudget(uint32_t bytes)
+{
+    budget = bytes;
+    Evict(budget);
+}
+
+uint32_t GlyphCache::GetBudget()
+{
+    return budget;
+}
+
+uint32_t GlyphCache::GetMemoryUsed()
+{
+    return memoryUsed;
+}
+
+uint32_t GlyphCache::GetCount()
+{
+    return entries.size();
+}
+
+uint32_t GlyphCache::GetHits()
+{
+    return hits;
+}
+
+uint32_t GlyphCache::GetMisses()
+{
+    return misses;
+}
+
+float GlyphCache::GetHitRate()
+{
+    uint32_t total = hits + misses;
+    return total > 0 ? (float)hits / (float)total : 0.0f;
+}
+
+void GlyphCache::ResetStats()
+{
+    hits = 0;
+    misses = 0;
+}
@@ -0,0 +1,84 @@
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include <list>
+#include <unordered_map>
+#include "surface.h"
+
+// How many bytes of glyph bitmaps can be cached by default, depending on whether PSRAM is available.
+#define GLYPHCACHE_BUDGET_PSRAM (128 * 1024)
+#define GLYPHCACHE_BUDGET_SRAM (16 * 1024)
+
+// Forward declarations
+class TFT_eSPI;
+
+/// Keeps pre-rasterized RGB565 glyphs so that text can be drawn as a sequence of blits rather than re-rasterized by TFT_eSPI.
+/// Glyphs are keyed by font, size, character and colors, and the least recently used glyphs are evicted to stay within budget.
+class GlyphCache
+{
+public:
+    // Takes the TFT_eSPI instance used to rasterize glyphs on a cache miss.
+    void Init(TFT_eSPI* tft);
+    void Destroy();
+
+    // Returns the glyph for a character, rasterizing it if it isn't cached. Returns nullptr if the glyph can't be allocated.
+    // The glyph is only guaranteed to remain valid until the next call.
+    Surface* Get(uint8_t font, uint8_t size, uint16_t codepoint, uint16_t fg, uint16_t bg);
+
+    // Evicts all glyphs.
+    void Clear();
+
+    // Set the maximum number of bytes of glyph bitmaps to keep, evicting glyphs if necessary.
+    void SetBudget(uint32_t bytes);
+
+    // Returns the maximum number of bytes of glyph bitmaps to keep.
+    uint32_t GetBudget();
+
+    // Returns how many bytes of glyph bitmaps are cached.
+    uint32_t GetMemoryUsed();
+
+    // Returns the number of cached glyphs.
+    uint32_t GetCount();
+
+    // Returns how many lookups found a cached glyph.
+    uint32_t GetHits();
+
+    // Returns how many lookups had to rasterize a glyph.
+    uint32_t GetMisses();
+
+    // Returns the fraction of lookups that found a cached glyph, between 0 and 1.
+    float GetHitRate();
+
+    // Resets the hit and miss counters.
+    void ResetStats();
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        Surface glyph;
+    };
+
+    // Rasterizes a glyph through TFT_eSPI. Returns false if memory couldn't be allocated.
+    bool Rasterize(Surface* glyph, uint8_t font, uint8_t size, uint16_t codepoint, uint16_t fg, uint16_t bg);
+
+    // Evicts the least recently used glyphs until the memory used is within a given number of bytes.
+    void Evict(uint32_t limit);
+
+    // Cached glyphs, the most recently used at the front.
+    std::list<Entry> entries;
+
+    // Finds cached glyphs by key.
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> lookup;
+
+    // Used for rasterizing glyphs.
+    TFT_eSPI* tft = nullptr;
+
+    uint32_t budget = GLYPHCACHE_BUDGET_SRAM;
+    uint32_t memoryUsed = 0;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+
+};
+
+#endif // GLYPHCACHE_H
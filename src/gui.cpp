@@ -95,37 +95,200 @@ bool Button::IsPressed()
 // Text
 //
 
+// Number of recent measurements shared by all text, must be a power of two.
+#define TEXT_MEASURE_CACHE_SIZE 32
+
+// A memoized text measurement.
+struct TextMeasurement
+{
+    // Hash of the string, font and size. Zero when unused.
+    uint32_t key;
+    uint16_t length;
+    uint16_t width;
+};
+
+static TextMeasurement measureCache[TEXT_MEASURE_CACHE_SIZE] = {};
+
+// FNV-1a hash of a string, continuing from a given hash.
+static uint32_t HashText(const char* text, unsigned int length, uint32_t hash = 2166136261UL)
+{
+    for (unsigned int i = 0; i < length; i++)
+    {
+        hash = (hash ^ (uint8_t)text[i]) * 16777619UL;
+    }
+    return hash;
+}
+
 void Text::Render(Display& display, const Vector2& offset)
 {
     if (refresh)
     {
         refresh = false;
 
+        UpdateLayout(display);
+
+        // Clear old text area
+        display.FillRect((IntRect){(int)oldArea.x + (int)offset.x, (int)oldArea.y + (int)offset.y, oldArea.w > 0 ? oldArea.w : width, oldArea.h > 0 ? oldArea.h : height}, bg);
+
+        // True position is based on the datum.
+        oldArea.x = rect.x - datumX;
+        oldArea.y = rect.y - datumY;
+        oldArea.w = width;
+        oldArea.h = height;
+
+        GlyphCache* glyphs = display.GetGlyphCache();
+        int y = (int)oldArea.y + (int)offset.y;
+        for (unsigned int i = 0, counti = lines.size(); i < counti; i++, y += lineHeight)
+        {
+            TextLine& line = lines[i];
+            // Lines are aligned within the text area horizontally by the datum.
+            int x = (int)oldArea.x + (int)offset.x;
+            if (datum == TC_DATUM || datum == MC_DATUM || datum == BC_DATUM)
+            {
+                x += (width - line.width) / 2;
+            }
+            else if (datum == TR_DATUM || datum == MR_DATUM || datum == BR_DATUM)
+            {
+                x += width - line.width;
+            }
+
+            if (bakedFont != nullptr)
+            {
+                display.DrawText(bakedFont, counti == 1 ? text.c_str() : text.substr(line.start, line.length).c_str(), x, y, fg, bg);
+                continue;
+            }
+
+            // Draw each character as a cached glyph.
+            IntRect dest = {x, y, 0, 0};
+            for (unsigned int j = line.start, countj = line.start + line.length; j < countj; j++)
+            {
+                Surface* glyph = glyphs->Get(textFont, textSize, (uint8_t)text[j], fg, bg);
+                if (glyph == nullptr)
+                {
+                    break;
+                }
+                dest.w = glyph->GetWidth();
+                dest.h = glyph->GetHeight();
+                display.Blit(glyph, &dest);
+                dest.x += dest.w;
+            }
+        }
+    }
+}
+
+void Text::UpdateLayout(Display& display)
+{
+    // Anything that changes the layout changes the hash.
+    uint32_t style[] = { (uint32_t)(uintptr_t)bakedFont, textFont, textSize, wrapText, rect.w, datum };
+    uint32_t hash = HashText(text.c_str(), text.length(), HashText((const char*)style, sizeof(style)));
+    if (hash == layoutHash && !lines.empty())
+    {
+        return;
+    }
+    layoutHash = hash;
+
+    if (bakedFont != nullptr)
+    {
+        lineHeight = bakedFont->height;
+    }
+    else
+    {
         TFT_eSPI* tft = display.GetTFT();
-        tft->setTextWrap(wrapText);
-        tft->setTextDatum(datum);
         tft->setTextFont(textFont);
         tft->setTextSize(textSize);
-        tft->setTextColor(fg);
+        lineHeight = tft->fontHeight();
+    }
 
-        width = tft->textWidth(text.c_str());
-        // TODO: account for wrapping.
-        height = tft->fontHeight();
+    // Break into lines at newlines, and between words when wrapping.
+    lines.clear();
+    const char* str = text.c_str();
+    unsigned int length = text.length();
+    unsigned int start = 0;
+    while (true)
+    {
+        unsigned int end = start;
+        while (end < length && str[end] != '\n')
+        {
+            end++;
+        }
 
-        // Clear old text area
-        tft->fillRect((int32_t)oldArea.x + (int32_t)offset.x, (int32_t)oldArea.y + (int32_t)offset.y, oldArea.w > 0 ? oldArea.w : width, oldArea.h > 0 ? oldArea.h : height, bg);
+        unsigned int lineStart = start;
+        while (true)
+        {
+            unsigned int lineEnd = end;
+            if (wrapText)
+            {
+                // Take whole words while they fit. A word that is too wide on its own still gets a line.
+                lineEnd = lineStart;
+                while (lineEnd < end)
+                {
+                    unsigned int wordEnd = lineEnd;
+                    while (wordEnd < end && str[wordEnd] == ' ')
+                    {
+                        wordEnd++;
+                    }
+                    while (wordEnd < end && str[wordEnd] != ' ')
+                    {
+                        wordEnd++;
+                    }
+                    if (lineEnd > lineStart && Measure(display, str + lineStart, wordEnd - lineStart) > rect.w)
+                    {
+                        break;
+                    }
+                    lineEnd = wordEnd;
+                }
+            }
 
-        uint8_t x, y;
-        GetDatumOffset(width, height, &x, &y);
+            TextLine line;
+            line.start = lineStart;
+            line.length = lineEnd - lineStart;
+            line.width = min(Measure(display, str + lineStart, line.length), 255);
+            lines.push_back(line);
 
-        // True position is based on the datum.
-        oldArea.x = rect.x - x;
-        oldArea.y = rect.y - y;
-        oldArea.w = width;
-        oldArea.h = height;
+            // Spaces at a break aren't drawn.
+            lineStart = lineEnd;
+            while (lineStart < end && str[lineStart] == ' ')
+            {
+                lineStart++;
+            }
+            if (lineStart >= end)
+            {
+                break;
+            }
+        }
 
-        tft->drawString(text.c_str(), (int32_t)rect.x + (int32_t)offset.x, (int32_t)rect.y + (int32_t)offset.x, textFont);
+        if (end >= length)
+        {
+            break;
+        }
+        start = end + 1;
     }
+
+    width = 0;
+    for (unsigned int i = 0, counti = lines.size(); i < counti; i++)
+    {
+        width = max(width, lines[i].width);
+    }
+    height = min((int)lines.size() * lineHeight, 255);
+    GetDatumOffset(width, height, &datumX, &datumY);
+}
+
+int Text::Measure(Display& display, const char* str, unsigned int length)
+{
+    uint32_t style[] = { (uint32_t)(uintptr_t)bakedFont, textFont, textSize };
+    uint32_t key = HashText(str, length, HashText((const char*)style, sizeof(style)));
+    key += key == 0;
+    TextMeasurement& entry = measureCache[key & (TEXT_MEASURE_CACHE_SIZE - 1)];
+    if (entry.key == key && entry.length == length)
+    {
+        return entry.width;
+    }
+
+    std::string part = std::string(str, length);
+    entry.key = key;
+    entry.length = length;
+    entry.width = bakedFont != nullptr ? bakedFont->GetTextWidth(part.c_str()) : display.GetTFT()->textWidth(part.c_str());
+    return entry.width;
 }
 
 void Text::SetText(const char* text)
@@ -197,8 +360,15 @@ uint8_t Text::GetSize()
 
 void Text::SetFont(uint8_t selectFont)
 {
-    refresh |= selectFont != textFont;
+    refresh |= selectFont != textFont || bakedFont != nullptr;
     textFont = selectFont;
+    bakedFont = nullptr;
+}
+
+void Text::SetFont(const BakedFont* font)
+{
+    refresh |= font != bakedFont;
+    bakedFont = font;
 }
 
 uint8_t Text::GetFont()
@@ -206,6 +376,11 @@ uint8_t Text::GetFont()
     return textFont;
 }
 
+const BakedFont* Text::GetBakedFont()
+{
+    return bakedFont;
+}
+
 void Text::GetDatumOffset(uint8_t width, uint8_t height, uint8_t* x, uint8_t* y)
 {
     /**
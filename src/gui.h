@@ -4,6 +4,7 @@
 #include "coremaths.h"
 #include "kernel.h"
 #include <functional>
+#include <vector>
 
 class Uint8Rect
 {
@@ -71,6 +72,19 @@ private:
 
 };
 
+// A line of text after wrapping.
+struct TextLine
+{
+    // Index of the first character of the line within the text.
+    uint16_t start;
+
+    // Number of characters in the line.
+    uint16_t length;
+
+    // Width of the line in pixels.
+    uint8_t width;
+};
+
 class Text : public Widget
 {
 public:
@@ -98,7 +112,7 @@ public:
     // Return the text background color, used to overwrite the old text.
     uint16_t GetClearColor();
 
-    // Set text wrapping.
+    // Set text wrapping, which breaks lines between words to fit within the maximum width.
     void SetWrap(bool wrap);
 
     // Is the text wrapping
@@ -116,19 +130,44 @@ public:
     // Return the font size in increments.
     uint8_t GetSize();
 
-    // Set the font to use.
+    // Set the TFT_eSPI font to use.
     void SetFont(uint8_t selectFont);
 
-    // Return the font used.
+    // Set a baked font to use instead of a TFT_eSPI font. Baked fonts have a fixed size, so the preset size is ignored.
+    void SetFont(const BakedFont* font);
+
+    // Return the TFT_eSPI font used.
     uint8_t GetFont();
 
+    // Return the baked font used, or nullptr if a TFT_eSPI font is used.
+    const BakedFont* GetBakedFont();
+
     // Outputs the anchor/datum position into x and y given a text width.
     void GetDatumOffset(uint8_t width, uint8_t height, uint8_t* x, uint8_t* y);
 
 private:
+    // Breaks the text into lines and measures it, only if the text or style has changed since the last layout.
+    void UpdateLayout(Display& display);
+
+    // Returns the width of part of the text in pixels, using recent measurements shared by all text where possible.
+    int Measure(Display& display, const char* str, unsigned int length);
+
     // The old area the text was drawn in.
     Uint8Rect oldArea;
 
+    // The text broken into lines.
+    std::vector<TextLine> lines;
+
+    // Hash of the text and style the lines were laid out with.
+    uint32_t layoutHash = 0;
+
+    // Height of each line.
+    uint8_t lineHeight = 0;
+
+    // Position of the datum relative to the top left of the text.
+    uint8_t datumX = 0;
+    uint8_t datumY = 0;
+
     // The text itself.
     std::string text;
 
@@ -141,6 +180,9 @@ private:
     // The current font to use.
     uint8_t textFont = 6;
 
+    // The baked font to use, if any.
+    const BakedFont* bakedFont = nullptr;
+
     // The preset size of the text.
     uint8_t textSize = 3;
 
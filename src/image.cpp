@@ -0,0 +1,101 @@
+#include <string.h>
+#include "image.h"
+
+void PackedImageDecoder::Begin(const PackedImage* image)
+{
+    this->image = image;
+    offset = 0;
+    row = 0;
+    if (lines.size() < (uint32_t)image->w * 2)
+    {
+        lines.resize((uint32_t)image->w * 2);
+    }
+}
+
+const uint16_t* PackedImageDecoder::NextRow()
+{
+    if (image == nullptr || row >= image->h)
+    {
+        return nullptr;
+    }
+
+    uint32_t w = image->w;
+    uint16_t* out = &lines[(row & 1) * w];
+    const uint16_t* above = &lines[((row + 1) & 1) * w];
+    const uint8_t* data = image->data;
+    uint32_t size = image->size;
+
+    uint32_t x = 0;
+    while (x < w)
+    {
+        if (offset >= size)
+        {
+            return nullptr;
+        }
+        uint8_t op = data[offset++];
+        uint32_t count = (op & 0x3F) + 1;
+        if (count == 64)
+        {
+            if (offset >= size)
+            {
+                return nullptr;
+            }
+            count += data[offset++];
+        }
+        if (x + count > w)
+        {
+            return nullptr;
+        }
+
+        switch (op >> 6)
+        {
+        case PACKEDOP_LITERAL:
+            if (offset + (count * 2) > size)
+            {
+                return nullptr;
+            }
+            // Stored low byte first, which is native order on the ESP32.
+            memcpy(&out[x], &data[offset], count * 2);
+            offset += count * 2;
+            break;
+        case PACKEDOP_RUN:
+        {
+            if (offset + 2 > size)
+            {
+                return nullptr;
+            }
+            uint16_t pixel = data[offset] | (data[offset + 1] << 8);
+            offset += 2;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                out[x + i] = pixel;
+            }
+            break;
+        }
+        case PACKEDOP_COPY_UP:
+            if (row == 0)
+            {
+                return nullptr;
+            }
+            memcpy(&out[x], &above[x], count * 2);
+            break;
+        default:
+            return nullptr;
+        }
+        x += count;
+    }
+
+    row++;
+    return out;
+}
+
+int PackedImageDecoder::GetRow()
+{
+    return row;
+}
+
+void PackedImageDecoder::Destroy()
+{
+    image = nullptr;
+    std::vector<uint16_t>().swap(lines);
+}
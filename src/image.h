@@ -0,0 +1,63 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdint.h>
+#include <vector>
+
+/// Opcodes of a packed image, in the top two bits of each op byte. The low six bits hold the pixel count minus one,
+/// unless they are all set, in which case the count is 64 plus the next byte. Ops never cross the end of a row.
+enum PackedImageOp
+{
+    /// Count RGB565 pixels follow, each stored low byte first.
+    PACKEDOP_LITERAL = 0,
+    /// One RGB565 pixel follows, repeated count times.
+    PACKEDOP_RUN,
+    /// Count pixels are copied from the same columns of the row above.
+    PACKEDOP_COPY_UP
+};
+
+/// An RGB565 image compressed at build time by tools/packimage.py into a constexpr array, which is kept in flash.
+/// Each row is a sequence of ops, so the image can be decoded a row at a time while only keeping the previous row.
+struct PackedImage
+{
+    /// Op stream, see PackedImageOp.
+    const uint8_t* data;
+    /// Number of bytes in the op stream.
+    uint32_t size;
+    /// Dimensions in pixels.
+    uint16_t w;
+    uint16_t h;
+};
+
+/// Decodes a packed image one row at a time into a pair of line buffers, which are kept between images.
+class PackedImageDecoder
+{
+public:
+    /// Starts decoding an image from the top row.
+    void Begin(const PackedImage* image);
+
+    /// Decodes the next row and returns its pixels in native byte order. The pixels stay valid until the row after next is decoded.
+    /// Returns nullptr after the last row, or if the image data is corrupt.
+    const uint16_t* NextRow();
+
+    /// Returns the index of the next row to be decoded.
+    int GetRow();
+
+    /// Frees the line buffers.
+    void Destroy();
+
+private:
+    const PackedImage* image = nullptr;
+
+    /// Position in the op stream.
+    uint32_t offset = 0;
+
+    /// Next row to decode.
+    int row = 0;
+
+    /// Two rows of pixels, the current and previous row alternating between each half.
+    std::vector<uint16_t> lines;
+
+};
+
+#endif // IMAGE_H
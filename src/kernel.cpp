@@ -5,6 +5,12 @@
 
 SemaphoreHandle_t gSystemMutex = nullptr;
 
+#ifdef FRAME_PROFILER
+#define PROFILE_PHASE(...) profiler.Enter(__VA_ARGS__)
+#else
+#define PROFILE_PHASE(...)
+#endif // FRAME_PROFILER
+
 Kernel::Kernel(TTGOClass* device, QueueHandle_t eventQueue)
 {
     // Initialise the watch
@@ -12,6 +18,8 @@ Kernel::Kernel(TTGOClass* device, QueueHandle_t eventQueue)
     driver->begin();
     // Setup display
     events = eventQueue;
+    // The kernel is created by the task that goes on to call Update().
+    task = xTaskGetCurrentTaskHandle();
     display.Init(driver);
 
     // Setup power monitoring
@@ -113,6 +121,10 @@ Kernel::~Kernel()
 
 void Kernel::Update()
 {
+#ifdef FRAME_PROFILER
+    profiler.BeginFrame();
+#endif // FRAME_PROFILER
+
     // Check for system-level input events
     bool eventOccurred = false;
     Event e;
@@ -123,13 +135,23 @@ void Kernel::Update()
         {
             EnterSleep();
         }
+        else if (e.type == EVENT_TOUCH_BEGIN)
+        {
+            touches |= 1 << e.touch.touchID;
+        }
+        else if (e.type == EVENT_TOUCH_END)
+        {
+            touches &= ~(1 << e.touch.touchID);
+        }
 
         // Now apps can handle the event. This happens even if an app is not in the foreground.
         for (unsigned int i = 0; i < totalApps; i++)
         {
             if (apps[i] != nullptr)
             {
+                PROFILE_PHASE(PROFILEPHASE_HANDLE_EVENT, i);
                 apps[i]->HandleEvent(e);
+                PROFILE_PHASE(PROFILEPHASE_EVENTS);
             }
         }
         // TODO: Only update napTimer for events that trigger a wakeup.
@@ -148,6 +170,7 @@ void Kernel::Update()
         {
             if (apps[i] != nullptr)
             {
+                PROFILE_PHASE(PROFILEPHASE_UPDATE, i);
                 apps[i]->Update();
             }
         }
@@ -155,17 +178,63 @@ void Kernel::Update()
 
     if (active)
     {
-        // Render foreground apps in reverse order; apps that are added first are then rendered on top.
+        // Only apps that have invalidated or asked for a frame by now render.
+        uint32_t now = millis();
+
+        // Apps with a layer render into it, then the changed layers are composed into the render buffer.
         for (int i = totalApps - 1; i >= 0; i--)
         {
-            if (apps[i] != nullptr && apps[i]->_foreground)
+            Layer* layer = apps[i] != nullptr ? apps[i]->layer : nullptr;
+            if (layer != nullptr)
             {
+                layer->SetVisible(apps[i]->_foreground);
+                if (apps[i]->_foreground && apps[i]->IsFrameDue(now))
+                {
+                    PROFILE_PHASE(PROFILEPHASE_RENDER, i);
+                    display.BeginLayer(layer);
+                    apps[i]->Render(display);
+                    display.EndLayer();
+                    apps[i]->FrameRendered(now);
+                }
+            }
+        }
+        PROFILE_PHASE(PROFILEPHASE_PRESENT);
+        bool composed = compositor.Compose(display);
+        bool direct = display.GetRenderBackend() == RENDERBACKEND_TFT;
+        if (composed && direct)
+        {
+            // Other apps draw straight to the panel, so only send the composed tiles, before those apps draw over them.
+            display.PresentDirtyTiles();
+        }
+
+        // Other foreground apps draw over each other, so if any is due they all render to keep the stacking order.
+        bool due = false;
+        for (unsigned int i = 0; i < totalApps && !due; i++)
+        {
+            due = apps[i] != nullptr && apps[i]->_foreground && apps[i]->layer == nullptr && apps[i]->IsFrameDue(now);
+        }
+
+        // Render them straight to the display in reverse order; apps that are added first are then rendered on top.
+        for (int i = totalApps - 1; i >= 0 && due; i--)
+        {
+            if (apps[i] != nullptr && apps[i]->_foreground && apps[i]->layer == nullptr)
+            {
+                PROFILE_PHASE(PROFILEPHASE_RENDER, i);
                 apps[i]->Render(display);
+                apps[i]->FrameRendered(now);
             }
         }
+
+        PROFILE_PHASE(PROFILEPHASE_PRESENT);
+        if (!direct && (composed || due))
+        {
+            // Other apps drew into the render buffer over the composed layers, so it all goes out together.
+            display.RenderPresent();
+        }
     }
 
     // Always delay to save some processing time, no matter if the display is active.
+    PROFILE_PHASE(PROFILEPHASE_WAIT);
     uint32_t frameWaitTime = DISPLAY_REFRESH_DELAY - renderTimer.GetTicks();
     if (frameWaitTime <= DISPLAY_REFRESH_DELAY)
     {
@@ -173,6 +242,22 @@ void Kernel::Update()
         vTaskDelay(frameWaitTime);
     }
 
+    if (active)
+    {
+        // Idle frames are skipped by sleeping until an app is due to render. Input events are only queued by loop()
+        // on this task, so interrupt handlers wake it early through WakeFromISR() instead.
+        uint32_t idleTime = GetIdleTime();
+        if (idleTime > 0)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idleTime));
+        }
+    }
+
+#ifdef FRAME_PROFILER
+    // Light-sleep stops the cycle counter, so the frame ends here.
+    profiler.EndFrame();
+#endif // FRAME_PROFILER
+
     // Restart the timer.
     renderTimer.Start();
 
@@ -184,16 +269,12 @@ void Kernel::Update()
         // Set inactive if not already.
         SetActive(false);
 
-        Log("Entering sleep mode...");
-
-        // First setup the power interrupts.
-        gpio_wakeup_enable((gpio_num_t)AXP202_INT, GPIO_INTR_LOW_LEVEL);
-        // Then the BMA interrupts.
-        esp_sleep_enable_ext1_wakeup(GPIO_SEL_39, ESP_EXT1_WAKEUP_ANY_HIGH);
-        esp_sleep_enable_gpio_wakeup();
-
-        // Start sleeping
-        esp_light_sleep_start();
+        // In always-on mode, UpdateAlwaysOn() sleeps between redraws of the watch face instead.
+        if (!alwaysOn || active)
+        {
+            Log("Entering sleep mode...");
+            Sleep(0);
+        }
     }
     else
     {
@@ -240,6 +321,8 @@ Application* Kernel::KillApp(int id, bool force)
             apps[id]->OnStop();
         }
         app = apps[id];
+        app->DestroyScratchSurfaces();
+        app->DestroyLayer();
         // Collapse the array for better performance.
         for (unsigned int i = id + 1; i < totalApps; i++)
         {
@@ -275,6 +358,14 @@ void Kernel::SetActive(bool active)
     {
         setCpuFrequencyMhz(160);
         display.Enable();
+        // The screen may be out of date after being off. Background apps don't draw, so leave them be.
+        for (unsigned int i = 0; i < totalApps; i++)
+        {
+            if (apps[i] != nullptr && apps[i]->_foreground)
+            {
+                apps[i]->Invalidate();
+            }
+        }
         //driver->touchToMonitor();
         EnableEvents(toggledEvents);
         napTimer.Start();
@@ -282,17 +373,137 @@ void Kernel::SetActive(bool active)
     else
     {
         DisableEvents(toggledEvents);
+        // No touch end events arrive while touch events are disabled.
+        touches = 0;
         //driver->touchToSleep();
-        display.Disable();
+        if (alwaysOn)
+        {
+            display.EnterAlwaysOn(ALWAYS_ON_TOP, ALWAYS_ON_BOTTOM);
+            alwaysOnMinute = 0xFF;
+        }
+        else
+        {
+            display.Disable();
+        }
         setCpuFrequencyMhz(10);
     }
 }
 
+uint32_t Kernel::GetIdleTime()
+{
+    // Wake up in time to put the watch to sleep.
+    uint32_t napTime = napTimer.GetTicks();
+    uint32_t idleTime = napTime < DISPLAY_TIMEOUT ? DISPLAY_TIMEOUT + 1 - napTime : 0;
+
+    // A held touch is polled by loop() for drags and the release, as the touch interrupt doesn't fire again for it.
+    if (touches != 0)
+    {
+        return 0;
+    }
+
+    uint32_t now = millis();
+    for (unsigned int i = 0; i < totalApps && idleTime > 0; i++)
+    {
+        // Only foreground apps render, so background apps never need waking up for.
+        Application* app = apps[i];
+        if (app == nullptr || !app->_foreground)
+        {
+            continue;
+        }
+        if (app->_invalidated)
+        {
+            return 0;
+        }
+        if (app->_frameInterval > 0)
+        {
+            int32_t untilFrame = (int32_t)(app->_nextFrame - now);
+            idleTime = min(idleTime, (uint32_t)max(untilFrame, (int32_t)0));
+        }
+    }
+    return idleTime;
+}
+
+void Kernel::WakeFromISR()
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    if (woken == pdTRUE)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
 bool Kernel::IsActive()
 {
     return active;
 }
 
+void Kernel::SetAlwaysOn(bool enable)
+{
+    alwaysOn = enable;
+    if (!active)
+    {
+        // Already inactive, so switch the display over now.
+        if (alwaysOn)
+        {
+            display.EnterAlwaysOn(ALWAYS_ON_TOP, ALWAYS_ON_BOTTOM);
+            alwaysOnMinute = 0xFF;
+        }
+        else
+        {
+            display.Disable();
+        }
+    }
+}
+
+bool Kernel::IsAlwaysOn()
+{
+    return alwaysOn;
+}
+
+void Kernel::UpdateAlwaysOn()
+{
+    RTC_Date date = driver->rtc->getDateTime();
+    if (date.minute != alwaysOnMinute)
+    {
+        alwaysOnMinute = date.minute;
+        for (int i = totalApps - 1; i >= 0; i--)
+        {
+            if (apps[i] != nullptr && apps[i]->_foreground)
+            {
+                apps[i]->RenderAlwaysOn(display);
+            }
+        }
+        if (display.GetRenderBackend() != RENDERBACKEND_TFT)
+        {
+            display.RenderPresent();
+        }
+    }
+
+    // The panel keeps showing the face by itself, so sleep until the start of the next minute.
+    Sleep((60 - min((int)date.second, 59)) * 1000);
+}
+
+void Kernel::Sleep(uint32_t timeout)
+{
+    // First setup the power interrupts.
+    gpio_wakeup_enable((gpio_num_t)AXP202_INT, GPIO_INTR_LOW_LEVEL);
+    // Then the BMA interrupts.
+    esp_sleep_enable_ext1_wakeup(GPIO_SEL_39, ESP_EXT1_WAKEUP_ANY_HIGH);
+    esp_sleep_enable_gpio_wakeup();
+    if (timeout > 0)
+    {
+        esp_sleep_enable_timer_wakeup((uint64_t)timeout * 1000);
+    }
+    else
+    {
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    }
+
+    // Start sleeping
+    esp_light_sleep_start();
+}
+
 void Kernel::EnableEvents(int32_t type)
 {
     enabledEventsMask |= (int32_t)type;
@@ -2,6 +2,8 @@
 #define WATCH_H
 
 #include "display.h"
+#include "compositor.h"
+#include "profiler.h"
 #include "time.h"
 #include <functional>
 
@@ -21,6 +23,13 @@
 // 6 second timeout of the display without any inputs.
 #define DISPLAY_TIMEOUT 6000
 
+// Keep the watch face on at low power when the watch goes to sleep, rather than turning the display off.
+//#define ALWAYS_ON_DISPLAY
+
+// Rows of the screen that stay on in always-on mode.
+#define ALWAYS_ON_TOP 80
+#define ALWAYS_ON_BOTTOM 159
+
 // Forward declarations
 class TTGOClass;
 class Application;
@@ -98,6 +107,7 @@ public:
     int StartApp(Application* app, bool foreground = true, int argc = 0, char* argv[] = NULL);
 
     // Kill an app that is running. Set force = true to skip calling Application::OnStop().
+    // Any scratch surfaces the app created are returned to the surface pool.
     // Returns the application that has been killed so it can be freed from memory if you wish.
     Application* KillApp(int id, bool force = false);
 
@@ -108,6 +118,17 @@ public:
     // Is this kernel operating?
     bool IsActive();
 
+    // Set whether the watch face stays on while the kernel is inactive, instead of the display turning off.
+    // The display is put into its low-power always-on mode and apps redraw it once a minute, see Application::RenderAlwaysOn().
+    void SetAlwaysOn(bool enable);
+
+    // Does the watch face stay on while the kernel is inactive?
+    bool IsAlwaysOn();
+
+    // Redraws the always-on watch face if the minute has changed, then sleeps until the next minute or an interrupt.
+    // Call this instead of Update() while the kernel is inactive in always-on mode.
+    void UpdateAlwaysOn();
+
     // Enable a specific event.
     void EnableEvents(int32_t type);
 
@@ -120,17 +141,42 @@ public:
     // Causes the watch to enter light-sleep power saving mode at the end of the next update.
     void EnterSleep();
 
+    // Wakes Update() early from waiting for an app to be due to render, so that input is handled straight away.
+    // Call this from interrupt handlers after setting the flag that loop() turns into events.
+    void WakeFromISR();
+
     Display display;
 
+    // Composes the layers of apps that render into one, see Application::CreateLayer().
+    Compositor compositor;
+
+#ifdef FRAME_PROFILER
+    // Times the phases of each update; the stats are dumped over serial every PROFILER_DUMP_FRAMES frames.
+    FrameProfiler profiler;
+#endif // FRAME_PROFILER
+
     TTGOClass* driver;
 
 private:
+    // Enters light-sleep until an interrupt, or until a timeout in milliseconds passes if it isn't 0.
+    void Sleep(uint32_t timeout);
+
+    // Returns how long until any app is due to render, capped to when the nap timeout runs out. Returns 0 while a touch
+    // is held, so that drags and the release are handled every frame.
+    uint32_t GetIdleTime();
+
     // Timer for putting the watch to sleep after some time without any input events.
     Timer napTimer;
 
     // Input event queue.
     QueueHandle_t events;
 
+    // Task that calls Update(), notified by WakeFromISR().
+    TaskHandle_t task = nullptr;
+
+    // Bit per touch ID that has begun and not yet ended.
+    uint8_t touches = 0;
+
     // All running applications, up to MAX_APPS as a stack.
     Application* apps[MAX_APPS] = { nullptr };
 
@@ -146,6 +192,12 @@ private:
     // Should the watch sleep at the end of the next update?
     bool sleepMode = false;
 
+    // Does the watch face stay on while inactive?
+    bool alwaysOn = false;
+
+    // The minute last drawn by UpdateAlwaysOn().
+    uint8_t alwaysOnMinute = 0xFF;
+
     // Timing and frame rate management
     Timer renderTimer;
 
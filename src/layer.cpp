@@ -0,0 +1,122 @@
+#include "layer.h"
+
+bool Layer::Init(int w, int h, uint8_t placement)
+{
+    surface.Init(w, h, PF_RGB565, placement);
+    if (surface.GetPixels() == nullptr)
+    {
+        return false;
+    }
+    MarkAllChanged();
+    return true;
+}
+
+void Layer::Destroy()
+{
+    surface.Destroy();
+}
+
+Surface* Layer::GetSurface()
+{
+    return &surface;
+}
+
+void Layer::SetPosition(int x, int y)
+{
+    if (x != this->x || y != this->y)
+    {
+        // Both where the layer was and where it is now need composing.
+        AddDamage(GetArea());
+        this->x = x;
+        this->y = y;
+        AddDamage(GetArea());
+    }
+}
+
+IntRect Layer::GetArea()
+{
+    return (IntRect){x, y, (int)surface.GetWidth(), (int)surface.GetHeight()};
+}
+
+void Layer::SetZ(int8_t z)
+{
+    if (z != this->z)
+    {
+        this->z = z;
+        AddDamage(GetArea());
+    }
+}
+
+int8_t Layer::GetZ()
+{
+    return z;
+}
+
+void Layer::SetOpacity(uint8_t opacity)
+{
+    if (opacity != this->opacity)
+    {
+        this->opacity = opacity;
+        AddDamage(GetArea());
+    }
+}
+
+uint8_t Layer::GetOpacity()
+{
+    return opacity;
+}
+
+void Layer::SetVisible(bool visible)
+{
+    if (visible != this->visible)
+    {
+        this->visible = visible;
+        AddDamage(GetArea());
+    }
+}
+
+bool Layer::IsVisible()
+{
+    return visible;
+}
+
+void Layer::MarkChanged(IntRect area)
+{
+    // Keep within the layer.
+    int startX = max(area.x, 0);
+    int startY = max(area.y, 0);
+    int endX = min(area.x + area.w, (int)surface.GetWidth());
+    int endY = min(area.y + area.h, (int)surface.GetHeight());
+    if (startX < endX && startY < endY)
+    {
+        AddDamage((IntRect){x + startX, y + startY, endX - startX, endY - startY});
+    }
+}
+
+void Layer::MarkAllChanged()
+{
+    AddDamage(GetArea());
+}
+
+bool Layer::IsChanged()
+{
+    return damage.w > 0 && damage.h > 0;
+}
+
+void Layer::AddDamage(IntRect area)
+{
+    if (area.w <= 0 || area.h <= 0)
+    {
+        return;
+    }
+    if (!IsChanged())
+    {
+        damage = area;
+        return;
+    }
+    int startX = min(damage.x, area.x);
+    int startY = min(damage.y, area.y);
+    int endX = max(damage.x + damage.w, area.x + area.w);
+    int endY = max(damage.y + damage.h, area.y + area.h);
+    damage = (IntRect){startX, startY, endX - startX, endY - startY};
+}
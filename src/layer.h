@@ -0,0 +1,72 @@
+#ifndef LAYER_H
+#define LAYER_H
+
+#include "surface.h"
+
+/// An off-screen RGB565 surface that an app renders into, which the kernel composes into the render buffer.
+/// The layer keeps track of the area of the screen that needs composing again since it was last composed.
+class Layer
+{
+public:
+    friend class Compositor;
+
+    // Allocates the layer surface. Returns false if it can't be allocated.
+    bool Init(int w, int h, uint8_t placement = PLACEMENT_SRAM);
+    void Destroy();
+
+    // Returns the surface drawn into.
+    Surface* GetSurface();
+
+    // Set where the top left of the layer is on screen.
+    void SetPosition(int x, int y);
+
+    // Returns the area the layer covers on screen.
+    IntRect GetArea();
+
+    // Set the stacking order; layers with a higher z are composed on top.
+    void SetZ(int8_t z);
+
+    // Return the stacking order.
+    int8_t GetZ();
+
+    // Set how opaque the layer is, from 0 (invisible) to 255 (opaque).
+    void SetOpacity(uint8_t opacity);
+
+    // Return how opaque the layer is.
+    uint8_t GetOpacity();
+
+    // Show or hide the layer.
+    void SetVisible(bool visible);
+
+    // Is the layer shown?
+    bool IsVisible();
+
+    // Marks an area of the layer surface as changed, so that it is composed again.
+    void MarkChanged(IntRect area);
+
+    // Marks the whole layer as changed.
+    void MarkAllChanged();
+
+    // Has any part of the layer changed since it was last composed?
+    bool IsChanged();
+
+private:
+    // Adds an area of the screen to the damage.
+    void AddDamage(IntRect area);
+
+    Surface surface;
+
+    // Position on screen.
+    int x = 0;
+    int y = 0;
+
+    int8_t z = 0;
+    uint8_t opacity = 255;
+    bool visible = true;
+
+    // Bounds of the screen area that needs composing again.
+    IntRect damage = {0, 0, 0, 0};
+
+};
+
+#endif // LAYER_H
@@ -40,6 +40,10 @@ void setup()
 
     InitInterrupts(kernel->driver);
 
+#ifdef ALWAYS_ON_DISPLAY
+    kernel->SetAlwaysOn(true);
+#endif // ALWAYS_ON_DISPLAY
+
     Log("Setup kernel.");
 
     // Finally, start the main app.
@@ -53,7 +57,7 @@ void InitInterrupts(TTGOClass* device)
     // Power interrupts
     //
     pinMode(AXP202_INT, INPUT_PULLUP);
-    attachInterrupt(AXP202_INT, [] { powerIRQ = true; }, FALLING);
+    attachInterrupt(AXP202_INT, [] { powerIRQ = true; kernel->WakeFromISR(); }, FALLING);
     device->power->enableIRQ(AXP202_PEK_SHORTPRESS_IRQ | AXP202_VBUS_REMOVED_IRQ | AXP202_VBUS_CONNECT_IRQ | AXP202_CHARGING_IRQ, true);
     device->power->clearIRQ();
 
@@ -61,7 +65,7 @@ void InitInterrupts(TTGOClass* device)
     // RTC interrupts
     //
     /*pinMode(RTC_INT, INPUT_PULLUP);
-    attachInterrupt(RTC_INT, [] { rtcIRQ = true; }, FALLING);
+    attachInterrupt(RTC_INT, [] { rtcIRQ = true; kernel->WakeFromISR(); }, FALLING);
     device->rtc->disableAlarm();*/
 
     // Initialise RTC based on compile time.
@@ -72,7 +76,7 @@ void InitInterrupts(TTGOClass* device)
     //
 
     pinMode(TOUCH_INT, INPUT_PULLUP);
-    attachInterrupt(TOUCH_INT, [] () { touchIRQ = true; }, FALLING);
+    attachInterrupt(TOUCH_INT, [] () { touchIRQ = true; kernel->WakeFromISR(); }, FALLING);
 
     //
     // BMA interrupts.
@@ -87,7 +91,7 @@ void InitInterrupts(TTGOClass* device)
     device->bma->attachInterrupt();
 
     pinMode(BMA423_INT1, INPUT);
-    attachInterrupt(BMA423_INT1, [] () { bmaIRQ = true; }, RISING);
+    attachInterrupt(BMA423_INT1, [] () { bmaIRQ = true; kernel->WakeFromISR(); }, RISING);
 
 }
 
@@ -279,6 +283,11 @@ void loop()
         // Update the watch runtime
         kernel->Update();
     }
+    else if (kernel->IsAlwaysOn())
+    {
+        // Keep the watch face up to date, sleeping in between.
+        kernel->UpdateAlwaysOn();
+    }
     else
     {
         // May as well save some processing cycles while inactive, interrupts will still be handled.
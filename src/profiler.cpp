@@ -0,0 +1,148 @@
+#include "profiler.h"
+
+#ifdef FRAME_PROFILER
+
+#include <algorithm>
+#include <string.h>
+#include "utils.h"
+
+uint32_t FrameProfiler::GetCycles()
+{
+    return ESP.getCycleCount();
+}
+
+void FrameProfiler::BeginFrame()
+{
+    memset(cycles, 0, sizeof(cycles));
+    memset(appCycles, 0, sizeof(appCycles));
+    phase = PROFILEPHASE_EVENTS;
+    app = -1;
+    start = GetCycles();
+}
+
+void FrameProfiler::Enter(ProfilePhase phase, int app)
+{
+    uint32_t now = GetCycles();
+    uint32_t elapsed = now - start;
+    cycles[this->phase] += elapsed;
+    if (this->app >= 0 && this->app < PROFILER_APPS && this->phase >= PROFILEPHASE_HANDLE_EVENT && this->phase <= PROFILEPHASE_RENDER)
+    {
+        appCycles[this->app][this->phase - PROFILEPHASE_HANDLE_EVENT] += elapsed;
+    }
+    this->phase = phase;
+    this->app = app;
+    start = now;
+}
+
+void FrameProfiler::EndFrame()
+{
+    Enter(PROFILEPHASE_FRAME);
+
+    // The CPU frequency changes between active and inactive frames, so convert to microseconds as each frame ends.
+    uint32_t mhz = max(getCpuFrequencyMhz(), (uint32_t)1);
+    uint32_t total = 0;
+    for (int i = 0; i < PROFILEPHASE_COUNT; i++)
+    {
+        uint32_t micros = i == PROFILEPHASE_FRAME ? total : cycles[i] / mhz;
+        total += micros;
+        samples[i][next] = micros;
+
+        int bucket = 0;
+        while (bucket < PROFILER_BUCKETS - 1 && micros >= (1u << bucket))
+        {
+            bucket++;
+        }
+        histograms[i][bucket]++;
+    }
+    for (int i = 0; i < PROFILER_APPS; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            appTotals[i][j] += appCycles[i][j] / mhz;
+        }
+    }
+
+    next = (next + 1) % PROFILER_SAMPLES;
+    frames++;
+#if PROFILER_DUMP_FRAMES > 0
+    if (frames % PROFILER_DUMP_FRAMES == 0)
+    {
+        Dump();
+    }
+#endif // PROFILER_DUMP_FRAMES
+}
+
+ProfileStats FrameProfiler::GetStats(ProfilePhase phase)
+{
+    ProfileStats stats = { 0, 0, 0, 0, min(frames, (uint32_t)PROFILER_SAMPLES) };
+    if (stats.frames == 0)
+    {
+        return stats;
+    }
+
+    // Only the filled part of the ring buffer counts, and order doesn't matter.
+    uint32_t sorted[PROFILER_SAMPLES];
+    memcpy(sorted, samples[phase], stats.frames * sizeof(uint32_t));
+    std::sort(sorted, sorted + stats.frames);
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < stats.frames; i++)
+    {
+        sum += sorted[i];
+    }
+    stats.min = sorted[0];
+    stats.avg = (uint32_t)(sum / stats.frames);
+    stats.p99 = sorted[((stats.frames * 99) + 99) / 100 - 1];
+    stats.max = sorted[stats.frames - 1];
+    return stats;
+}
+
+const uint32_t* FrameProfiler::GetHistogram(ProfilePhase phase)
+{
+    return histograms[phase];
+}
+
+uint32_t FrameProfiler::GetAppAverage(int app, ProfilePhase phase)
+{
+    if (app < 0 || app >= PROFILER_APPS || phase < PROFILEPHASE_HANDLE_EVENT || phase > PROFILEPHASE_RENDER || frames == 0)
+    {
+        return 0;
+    }
+    return (uint32_t)(appTotals[app][phase - PROFILEPHASE_HANDLE_EVENT] / frames);
+}
+
+const char* FrameProfiler::GetPhaseName(ProfilePhase phase)
+{
+    static const char* names[PROFILEPHASE_COUNT] = { "events", "handle event", "update", "render", "present", "wait", "frame" };
+    return phase < PROFILEPHASE_COUNT ? names[phase] : "unknown";
+}
+
+void FrameProfiler::Dump()
+{
+    Log("Frame profile over %u frames (us):", min(frames, (uint32_t)PROFILER_SAMPLES));
+    for (int i = 0; i < PROFILEPHASE_COUNT; i++)
+    {
+        ProfileStats stats = GetStats((ProfilePhase)i);
+        Log("  %-12s min %6u avg %6u p99 %6u max %6u", GetPhaseName((ProfilePhase)i), stats.min, stats.avg, stats.p99, stats.max);
+    }
+    for (int i = 0; i < PROFILER_APPS; i++)
+    {
+        uint32_t handleEvent = GetAppAverage(i, PROFILEPHASE_HANDLE_EVENT);
+        uint32_t update = GetAppAverage(i, PROFILEPHASE_UPDATE);
+        uint32_t render = GetAppAverage(i, PROFILEPHASE_RENDER);
+        if (handleEvent + update + render > 0)
+        {
+            Log("  app %-8d handle event %u update %u render %u avg per frame", i, handleEvent, update, render);
+        }
+    }
+}
+
+void FrameProfiler::Reset()
+{
+    memset(appTotals, 0, sizeof(appTotals));
+    memset(samples, 0, sizeof(samples));
+    memset(histograms, 0, sizeof(histograms));
+    next = 0;
+    frames = 0;
+}
+
+#endif // FRAME_PROFILER
@@ -0,0 +1,123 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+// Time each phase of Kernel::Update with the CPU cycle counter. Compiled out completely when not defined.
+//#define FRAME_PROFILER
+
+#ifdef FRAME_PROFILER
+
+// Number of frames kept for each phase to work out the stats from.
+#define PROFILER_SAMPLES 128
+
+// Number of power of two buckets in each histogram, the last also counting anything longer.
+#define PROFILER_BUCKETS 20
+
+// Number of apps timed separately, matching MAX_APPS.
+#define PROFILER_APPS 16
+
+// Frames between dumps of the stats over serial, or 0 to only dump when Dump() is called.
+#define PROFILER_DUMP_FRAMES PROFILER_SAMPLES
+
+// Phases of a frame. Each is timed exclusively, so time spent in an app's HandleEvent() isn't part of PROFILEPHASE_EVENTS.
+enum ProfilePhase
+{
+    // Receiving events and handling them at the system level.
+    PROFILEPHASE_EVENTS = 0,
+    // Apps handling events.
+    PROFILEPHASE_HANDLE_EVENT,
+    // Apps updating.
+    PROFILEPHASE_UPDATE,
+    // Apps rendering.
+    PROFILEPHASE_RENDER,
+    // Composing layers and sending the frame to the display.
+    PROFILEPHASE_PRESENT,
+    // Waiting for the next frame.
+    PROFILEPHASE_WAIT,
+    // The whole frame.
+    PROFILEPHASE_FRAME,
+    PROFILEPHASE_COUNT
+};
+
+// Stats of a phase over the last PROFILER_SAMPLES frames, in microseconds.
+struct ProfileStats
+{
+    uint32_t min;
+    uint32_t avg;
+    uint32_t p99;
+    uint32_t max;
+    // Number of frames the stats cover.
+    uint32_t frames;
+};
+
+/// Times the phases of each frame with the CPU cycle counter, so that a switch between phases costs a couple of reads.
+/// The time of each phase in a frame goes into a ring buffer of the last PROFILER_SAMPLES frames, and into a histogram
+/// of all frames since the last Reset().
+class FrameProfiler
+{
+public:
+    // Starts timing a frame, in PROFILEPHASE_EVENTS.
+    void BeginFrame();
+
+    // Switches to timing a phase, optionally on behalf of an app ID. Time since the last switch goes to the previous phase.
+    void Enter(ProfilePhase phase, int app = -1);
+
+    // Finishes timing the frame and records the time spent in each phase.
+    void EndFrame();
+
+    // Returns the stats of a phase.
+    ProfileStats GetStats(ProfilePhase phase);
+
+    // Returns the histogram of a phase, where bucket i counts frames that took less than 2^i microseconds
+    // (and at least half that).
+    const uint32_t* GetHistogram(ProfilePhase phase);
+
+    // Returns the average microseconds per frame an app has spent in PROFILEPHASE_HANDLE_EVENT, PROFILEPHASE_UPDATE
+    // or PROFILEPHASE_RENDER since the last Reset().
+    uint32_t GetAppAverage(int app, ProfilePhase phase);
+
+    // Returns the name of a phase.
+    static const char* GetPhaseName(ProfilePhase phase);
+
+    // Logs the stats of every phase, and of every app that has spent any time, over serial.
+    void Dump();
+
+    // Forgets all recorded frames.
+    void Reset();
+
+private:
+    // Reads the CPU cycle counter.
+    static uint32_t GetCycles();
+
+    // Cycles spent in each phase of the current frame.
+    uint32_t cycles[PROFILEPHASE_COUNT] = { 0 };
+
+    // Cycles spent by each app in the app phases of the current frame.
+    uint32_t appCycles[PROFILER_APPS][3] = { { 0 } };
+
+    // Microseconds spent by each app in the app phases since the last Reset().
+    uint64_t appTotals[PROFILER_APPS][3] = { { 0 } };
+
+    // Microseconds spent in each phase of the last PROFILER_SAMPLES frames, oldest first from next once full.
+    uint32_t samples[PROFILEPHASE_COUNT][PROFILER_SAMPLES] = { { 0 } };
+
+    // Frames counted by time spent in each phase.
+    uint32_t histograms[PROFILEPHASE_COUNT][PROFILER_BUCKETS] = { { 0 } };
+
+    // Where the next frame goes in the ring buffers.
+    uint32_t next = 0;
+
+    // Frames recorded since the last Reset().
+    uint32_t frames = 0;
+
+    // Phase and app being timed, and when they started.
+    uint8_t phase = PROFILEPHASE_EVENTS;
+    int app = -1;
+    uint32_t start = 0;
+
+};
+
+#endif // FRAME_PROFILER
+
+#endif // PROFILER_H
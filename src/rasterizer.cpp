@@ -0,0 +1,647 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "color.h"
+#include "rasterizer.h"
+
+// Maps 8-bit coverage (in steps of 4) to a 5-bit blend weight. The curve is gamma corrected so that
+// pixel pairs straddling a line keep a roughly even brightness, rather than dipping between pixels.
+static const uint8_t coverageToWeight[64] = {
+    0, 2, 3, 4, 5, 6, 7, 7, 8, 9, 9, 10, 11, 11, 12, 12,
+    13, 13, 14, 14, 15, 15, 16, 16, 17, 17, 18, 18, 19, 19, 20, 20,
+    20, 21, 21, 22, 22, 22, 23, 23, 24, 24, 24, 25, 25, 26, 26, 26,
+    27, 27, 27, 28, 28, 29, 29, 29, 30, 30, 30, 31, 31, 31, 32, 32
+};
+
+// Integer square root, rounded down.
+static uint32_t SquareRoot(uint32_t n)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > n)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (n >= root + bit)
+        {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+void Rasterizer::SetTarget(BaseSurface* target)
+{
+    this->target = target;
+    SetClip(nullptr);
+}
+
+BaseSurface* Rasterizer::GetTarget()
+{
+    return target;
+}
+
+void Rasterizer::SetClip(IntRect* area)
+{
+    IntRect bounds = {0, 0, 0, 0};
+    if (target != nullptr)
+    {
+        bounds.w = (int)target->GetWidth();
+        bounds.h = (int)target->GetHeight();
+    }
+    if (area == nullptr)
+    {
+        clip = bounds;
+        return;
+    }
+
+    // Keep the clip area within the target.
+    int startX = max(area->x, 0);
+    int startY = max(area->y, 0);
+    int endX = min(area->x + area->w, bounds.w);
+    int endY = min(area->y + area->h, bounds.h);
+    clip = (IntRect){startX, startY, max(endX - startX, 0), max(endY - startY, 0)};
+}
+
+IntRect Rasterizer::GetClip()
+{
+    return clip;
+}
+
+void Rasterizer::WritePixel(int x, int y, uint32_t color)
+{
+    if (IsIndexed(target->GetFormat()))
+    {
+        // Pixels don't start on byte boundaries, so leave the packing to the surface.
+        target->FillRect((IntRect){x, y, 1, 1}, color);
+        return;
+    }
+    uint8_t depth = GetDepth((PixelFormat)target->GetFormat());
+    uint8_t* pixel = (uint8_t*)target->GetPixels() + (y * target->GetPitch()) + (x * depth);
+    switch (depth)
+    {
+    case 4:
+        *((uint32_t*)pixel) = color;
+        break;
+    case 3:
+        pixel[0] = (uint8_t)color;
+        pixel[1] = (uint8_t)(color >> 8);
+        pixel[2] = (uint8_t)(color >> 16);
+        break;
+    default:
+        *((uint16_t*)pixel) = (uint16_t)color;
+        break;
+    }
+}
+
+void Rasterizer::BlendPixel(int x, int y, uint16_t color, uint32_t coverage)
+{
+    if (x < clip.x || y < clip.y || x >= clip.x + clip.w || y >= clip.y + clip.h)
+    {
+        return;
+    }
+    uint32_t weight = coverageToWeight[coverage >> 2];
+    if (weight == 0)
+    {
+        return;
+    }
+    uint16_t* pixel = (uint16_t*)((uint8_t*)target->GetPixels() + (y * target->GetPitch())) + x;
+    if (weight == 32)
+    {
+        *pixel = color;
+    }
+    else if (target->GetFormat() == PF_RGB565_BE)
+    {
+        *pixel = Swap565(Blend565(Swap565(*pixel), Swap565(color), weight));
+    }
+    else
+    {
+        *pixel = Blend565(*pixel, color, weight);
+    }
+}
+
+void Rasterizer::DrawPixel(int x, int y, uint32_t color)
+{
+    if (x >= clip.x && y >= clip.y && x < clip.x + clip.w && y < clip.y + clip.h)
+    {
+        WritePixel(x, y, color);
+    }
+}
+
+void Rasterizer::DrawHLine(int x, int y, int w, uint32_t color)
+{
+    if (y < clip.y || y >= clip.y + clip.h)
+    {
+        return;
+    }
+    int startX = max(x, clip.x);
+    int endX = min(x + w, clip.x + clip.w);
+    if (startX < endX)
+    {
+        target->FillRect((IntRect){startX, y, endX - startX, 1}, color);
+    }
+}
+
+void Rasterizer::DrawVLine(int x, int y, int h, uint32_t color)
+{
+    if (x < clip.x || x >= clip.x + clip.w)
+    {
+        return;
+    }
+    int startY = max(y, clip.y);
+    int endY = min(y + h, clip.y + clip.h);
+    for (int i = startY; i < endY; i++)
+    {
+        WritePixel(x, i, color);
+    }
+}
+
+void Rasterizer::DrawLine(int x0, int y0, int x1, int y1, uint32_t color)
+{
+    if (y0 == y1)
+    {
+        DrawHLine(min(x0, x1), y0, abs(x1 - x0) + 1, color);
+        return;
+    }
+    if (x0 == x1)
+    {
+        DrawVLine(x0, min(y0, y1), abs(y1 - y0) + 1, color);
+        return;
+    }
+
+    // Skip lines that can't touch the clip area.
+    if (max(x0, x1) < clip.x || min(x0, x1) >= clip.x + clip.w || max(y0, y1) < clip.y || min(y0, y1) >= clip.y + clip.h)
+    {
+        return;
+    }
+
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int stepX = x0 < x1 ? 1 : -1;
+    int stepY = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    while (true)
+    {
+        DrawPixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1)
+        {
+            break;
+        }
+        int error2 = error * 2;
+        if (error2 >= dy)
+        {
+            error += dy;
+            x0 += stepX;
+        }
+        if (error2 <= dx)
+        {
+            error += dx;
+            y0 += stepY;
+        }
+    }
+}
+
+void Rasterizer::FillRect(IntRect rect, uint32_t color)
+{
+    int startX = max(rect.x, clip.x);
+    int startY = max(rect.y, clip.y);
+    int endX = min(rect.x + rect.w, clip.x + clip.w);
+    int endY = min(rect.y + rect.h, clip.y + clip.h);
+    if (startX < endX && startY < endY)
+    {
+        target->FillRect((IntRect){startX, startY, endX - startX, endY - startY}, color);
+    }
+}
+
+void Rasterizer::DrawCircle(int cx, int cy, int r, uint32_t color)
+{
+    if (r < 0)
+    {
+        return;
+    }
+
+    int f = 1 - r;
+    int ddx = 1;
+    int ddy = -2 * r;
+    int x = 0;
+    int y = r;
+
+    DrawPixel(cx, cy + r, color);
+    DrawPixel(cx, cy - r, color);
+    DrawPixel(cx + r, cy, color);
+    DrawPixel(cx - r, cy, color);
+
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddy += 2;
+            f += ddy;
+        }
+        x++;
+        ddx += 2;
+        f += ddx;
+
+        DrawPixel(cx + x, cy + y, color);
+        DrawPixel(cx - x, cy + y, color);
+        DrawPixel(cx + x, cy - y, color);
+        DrawPixel(cx - x, cy - y, color);
+        DrawPixel(cx + y, cy + x, color);
+        DrawPixel(cx - y, cy + x, color);
+        DrawPixel(cx + y, cy - x, color);
+        DrawPixel(cx - y, cy - x, color);
+    }
+}
+
+void Rasterizer::FillCircle(int cx, int cy, int r, uint32_t color)
+{
+    if (r < 0)
+    {
+        return;
+    }
+
+    int f = 1 - r;
+    int ddx = 1;
+    int ddy = -2 * r;
+    int x = 0;
+    int y = r;
+    int lastX = x;
+    int lastY = y;
+
+    DrawHLine(cx - r, cy, (2 * r) + 1, color);
+
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddy += 2;
+            f += ddy;
+        }
+        x++;
+        ddx += 2;
+        f += ddx;
+
+        // Each row is only drawn once.
+        if (x < y + 1)
+        {
+            DrawHLine(cx - y, cy + x, (2 * y) + 1, color);
+            DrawHLine(cx - y, cy - x, (2 * y) + 1, color);
+        }
+        if (y != lastY)
+        {
+            DrawHLine(cx - lastX, cy + lastY, (2 * lastX) + 1, color);
+            DrawHLine(cx - lastX, cy - lastY, (2 * lastX) + 1, color);
+            lastY = y;
+        }
+        lastX = x;
+    }
+}
+
+void Rasterizer::DrawLineAA(float x0, float y0, float x1, float y1, uint32_t color)
+{
+    if (target->GetFormat() != PF_RGB565 && target->GetFormat() != PF_RGB565_BE)
+    {
+        DrawLine((int)lroundf(x0), (int)lroundf(y0), (int)lroundf(x1), (int)lroundf(y1), color);
+        return;
+    }
+
+    // Walk along the major axis, so that each step covers exactly two pixels of the minor axis.
+    bool steep = fabsf(y1 - y0) > fabsf(x1 - x0);
+    if (steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    float dx = x1 - x0;
+    float gradient = dx == 0.0f ? 0.0f : (y1 - y0) / dx;
+
+    // Only walk the columns inside the clip area.
+    int startX = (int)floorf(x0 + 0.5f);
+    int endX = (int)floorf(x1 + 0.5f);
+    int clipStart = steep ? clip.y : clip.x;
+    int clipEnd = (steep ? clip.y + clip.h : clip.x + clip.w) - 1;
+    startX = max(startX, clipStart);
+    endX = min(endX, clipEnd);
+    if (startX > endX)
+    {
+        return;
+    }
+
+    // Floating point is only used for setup; the minor axis position is then stepped in 16.16 fixed-point.
+    int32_t y = (int32_t)((y0 + (gradient * (startX - x0))) * 65536.0f);
+    int32_t step = (int32_t)(gradient * 65536.0f);
+    for (int x = startX; x <= endX; x++)
+    {
+        int row = y >> 16;
+        uint32_t coverage = (y >> 8) & 0xFF;
+        if (steep)
+        {
+            BlendPixel(row, x, color, 255 - coverage);
+            BlendPixel(row + 1, x, color, coverage);
+        }
+        else
+        {
+            BlendPixel(x, row, color, 255 - coverage);
+            BlendPixel(x, row + 1, color, coverage);
+        }
+        y += step;
+    }
+}
+
+void Rasterizer::DrawCircleAA(int cx, int cy, int r, uint32_t color)
+{
+    if ((target->GetFormat() != PF_RGB565 && target->GetFormat() != PF_RGB565_BE) || r > 255)
+    {
+        DrawCircle(cx, cy, r, color);
+        return;
+    }
+    if (r < 0)
+    {
+        return;
+    }
+
+    // Skip circles that can't touch the clip area.
+    if (cx + r < clip.x || cx - r >= clip.x + clip.w || cy + r < clip.y || cy - r >= clip.y + clip.h)
+    {
+        return;
+    }
+
+    uint32_t radiusSquared = (uint32_t)(r * r);
+    for (int x = 0; ; x++)
+    {
+        // Exact height of the circle at this column in 8.8 fixed-point; the fraction splits coverage between two rows.
+        uint32_t height = SquareRoot((radiusSquared - (uint32_t)(x * x)) << 16);
+        int y = height >> 8;
+        if (x > y)
+        {
+            break;
+        }
+        uint32_t outer = height & 0xFF;
+        uint32_t inner = 255 - outer;
+
+        // Plot the two rows in each octant. The axes only have four points, and the diagonal is shared by two octants.
+        for (int i = 0; i < 2; i++)
+        {
+            int h = y + i;
+            uint32_t coverage = i == 0 ? inner : outer;
+            BlendPixel(cx + x, cy + h, color, coverage);
+            BlendPixel(cx + x, cy - h, color, coverage);
+            if (x != 0)
+            {
+                BlendPixel(cx - x, cy + h, color, coverage);
+                BlendPixel(cx - x, cy - h, color, coverage);
+            }
+            if (h != x)
+            {
+                BlendPixel(cx + h, cy + x, color, coverage);
+                BlendPixel(cx - h, cy + x, color, coverage);
+                if (x != 0)
+                {
+                    BlendPixel(cx + h, cy - x, color, coverage);
+                    BlendPixel(cx - h, cy - x, color, coverage);
+                }
+            }
+        }
+    }
+}
+
+void Rasterizer::DrawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color)
+{
+    DrawLine(x0, y0, x1, y1, color);
+    DrawLine(x1, y1, x2, y2, color);
+    DrawLine(x2, y2, x0, y0, color);
+}
+
+void Rasterizer::FillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color)
+{
+    // Sort vertices by y so that y0 <= y1 <= y2.
+    if (y0 > y1)
+    {
+        std::swap(y0, y1);
+        std::swap(x0, x1);
+    }
+    if (y1 > y2)
+    {
+        std::swap(y1, y2);
+        std::swap(x1, x2);
+    }
+    if (y0 > y1)
+    {
+        std::swap(y0, y1);
+        std::swap(x0, x1);
+    }
+
+    if (y0 == y2)
+    {
+        // Degenerate, all on one row.
+        int a = min(x0, min(x1, x2));
+        int b = max(x0, max(x1, x2));
+        DrawHLine(a, y0, b - a + 1, color);
+        return;
+    }
+
+    int dx01 = x1 - x0;
+    int dy01 = y1 - y0;
+    int dx02 = x2 - x0;
+    int dy02 = y2 - y0;
+    int dx12 = x2 - x1;
+    int dy12 = y2 - y1;
+
+    // Only rows inside the clip area are walked; the edge accumulators are advanced to the first visible row.
+    int clipTop = clip.y;
+    int clipBottom = clip.y + clip.h - 1;
+
+    // Upper part, between edges 0-1 and 0-2. Includes row y1 if the lower part is flat.
+    int last = y1 == y2 ? y1 : y1 - 1;
+    int y = max(y0, clipTop);
+    int32_t sa = dx01 * (y - y0);
+    int32_t sb = dx02 * (y - y0);
+    for (int end = min(last, clipBottom); y <= end; y++)
+    {
+        int a = x0 + (sa / dy01);
+        int b = x0 + (sb / dy02);
+        sa += dx01;
+        sb += dx02;
+        if (a > b)
+        {
+            std::swap(a, b);
+        }
+        DrawHLine(a, y, b - a + 1, color);
+    }
+
+    // Lower part, between edges 1-2 and 0-2.
+    y = max(last + 1, clipTop);
+    sa = dx12 * (y - y1);
+    sb = dx02 * (y - y0);
+    for (int end = min(y2, clipBottom); y <= end; y++)
+    {
+        int a = x1 + (sa / dy12);
+        int b = x0 + (sb / dy02);
+        sa += dx12;
+        sb += dx02;
+        if (a > b)
+        {
+            std::swap(a, b);
+        }
+        DrawHLine(a, y, b - a + 1, color);
+    }
+}
+
+void Rasterizer::FillPolygon(const Point* vertices, int count, uint32_t color)
+{
+    ScanPolygon(vertices, count, clip, [&] (int x, int y, int w) {
+        target->FillRect((IntRect){x, y, w, 1}, color);
+    });
+}
+
+bool Rasterizer::BuildEdgeTable(const Point* vertices, int count, IntRect clip)
+{
+    int clipTop = clip.y;
+    int clipBottom = clip.y + clip.h;
+
+    // Floating point is only used here, once per vertex.
+    edges.clear();
+    for (int i = 0; i < count; i++)
+    {
+        const Point* a = &vertices[i];
+        const Point* b = &vertices[(i + 1) % count];
+        if (a->y > b->y)
+        {
+            std::swap(a, b);
+        }
+
+        // Scanlines are sampled at pixel centres.
+        PolygonEdge edge;
+        edge.startY = (int)ceilf(a->y - 0.5f);
+        edge.endY = (int)ceilf(b->y - 0.5f);
+        if (edge.startY >= edge.endY || edge.endY <= clipTop || edge.startY >= clipBottom)
+        {
+            // Horizontal, or outside the clip area.
+            continue;
+        }
+
+        float slope = (b->x - a->x) / (b->y - a->y);
+        // Start at the first visible scanline.
+        edge.startY = max(edge.startY, clipTop);
+        edge.endY = min(edge.endY, clipBottom);
+        edge.x = (int32_t)((a->x + (((edge.startY + 0.5f) - a->y) * slope)) * 65536.0f);
+        edge.slope = (int32_t)(slope * 65536.0f);
+        edges.push_back(edge);
+    }
+    if (edges.empty())
+    {
+        return false;
+    }
+
+    std::sort(edges.begin(), edges.end(), [] (const PolygonEdge& a, const PolygonEdge& b) { return a.startY < b.startY; });
+    return true;
+}
+
+void Rasterizer::DrawText(const BakedFont* font, const char* text, int x, int y, uint16_t fg, uint16_t bg)
+{
+    // Work out the color of each coverage level once, rather than per pixel.
+    uint32_t palette[16];
+    int levels = (1 << font->bpp) - 1;
+    uint16_t format = target->GetFormat();
+    for (int i = 1; i <= levels; i++)
+    {
+        uint32_t weight = ((i * 32) + (levels / 2)) / levels;
+        if (format == PF_RGB565)
+        {
+            palette[i] = Blend565(bg, fg, weight);
+        }
+        else if (format == PF_RGB565_BE)
+        {
+            palette[i] = Swap565(Blend565(Swap565(bg), Swap565(fg), weight));
+        }
+        else
+        {
+            palette[i] = fg;
+        }
+    }
+    ScanText(font, text, x, y, clip, [&] (int x, int y, int w, uint8_t level) {
+        target->FillRect((IntRect){x, y, w, 1}, palette[level]);
+    });
+}
+
+void Rasterizer::ScanText(const BakedFont* font, const char* text, int x, int y, IntRect clip, const std::function<void(int, int, int, uint8_t)>& span)
+{
+    int clipRight = clip.x + clip.w;
+    int clipBottom = clip.y + clip.h;
+    int bpp = font->bpp;
+    uint8_t mask = (1 << bpp) - 1;
+    uint16_t previous = 0;
+    for (const char* c = text; *c != '\0'; c++)
+    {
+        uint16_t codepoint = (uint8_t)*c;
+        const BakedGlyph* glyph = font->GetGlyph(codepoint);
+        if (glyph == nullptr)
+        {
+            previous = 0;
+            continue;
+        }
+        if (previous != 0)
+        {
+            x += font->GetKerning(previous, codepoint);
+        }
+        previous = codepoint;
+
+        int left = x + glyph->x;
+        int top = y + glyph->y;
+        x += glyph->advance;
+        if (left >= clipRight || left + glyph->w <= clip.x || top >= clipBottom || top + glyph->h <= clip.y)
+        {
+            continue;
+        }
+
+        int rowBytes = font->GetRowBytes(glyph);
+        int startRow = max(clip.y - top, 0);
+        int endRow = min(clipBottom - top, (int)glyph->h);
+        const uint8_t* row = font->bitmaps + glyph->offset + (startRow * rowBytes);
+        for (int j = startRow; j < endRow; j++, row += rowBytes)
+        {
+            // Runs end when the level changes; the extra step past the last pixel closes the final run.
+            int runStart = 0;
+            uint8_t runLevel = 0;
+            for (int i = 0; i <= glyph->w; i++)
+            {
+                uint8_t level = 0;
+                if (i < glyph->w)
+                {
+                    int bit = i * bpp;
+                    level = (row[bit >> 3] >> (8 - bpp - (bit & 7))) & mask;
+                }
+                if (level == runLevel)
+                {
+                    continue;
+                }
+                if (runLevel != 0)
+                {
+                    int startX = max(left + runStart, clip.x);
+                    int endX = min(left + i, clipRight);
+                    if (startX < endX)
+                    {
+                        span(startX, top + j, endX - startX, runLevel);
+                    }
+                }
+                runStart = i;
+                runLevel = level;
+            }
+        }
+    }
+}
@@ -0,0 +1,172 @@
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+
+#include <functional>
+#include <vector>
+#include "surface.h"
+#include "font.h"
+
+// A polygon edge used during scan conversion.
+struct PolygonEdge
+{
+    // First scanline crossed by this edge.
+    int startY;
+    // Scanline after the last one crossed.
+    int endY;
+    // 16.16 fixed-point x position at the centre of the current scanline.
+    int32_t x;
+    // 16.16 fixed-point change in x per scanline.
+    int32_t slope;
+};
+
+/// Draws primitive shapes into a surface using integer algorithms, clipped to a given area.
+/// Colors are raw pixels in the format of the target surface, see BaseSurface::Clear().
+class Rasterizer
+{
+public:
+    /// Set the surface to draw into. Resets the clip area to cover the whole surface.
+    void SetTarget(BaseSurface* target);
+
+    /// Returns the surface being drawn into.
+    BaseSurface* GetTarget();
+
+    /// Restrict drawing to an area of the target. Pass NULL to draw anywhere on the target.
+    void SetClip(IntRect* area);
+
+    /// Returns the area drawing is restricted to.
+    IntRect GetClip();
+
+    void DrawPixel(int x, int y, uint32_t color);
+
+    /// Draws a horizontal span of w pixels starting at x.
+    void DrawHLine(int x, int y, int w, uint32_t color);
+
+    /// Draws a vertical span of h pixels starting at y.
+    void DrawVLine(int x, int y, int h, uint32_t color);
+
+    /// Draws a line between two points inclusive, using Bresenham's algorithm.
+    void DrawLine(int x0, int y0, int x1, int y1, uint32_t color);
+
+    void FillRect(IntRect rect, uint32_t color);
+
+    /// Draws the outline of a circle using the midpoint algorithm.
+    void DrawCircle(int cx, int cy, int r, uint32_t color);
+
+    /// Draws a solid circle as horizontal spans.
+    void FillCircle(int cx, int cy, int r, uint32_t color);
+
+    /// Draws an anti-aliased line between two sub-pixel positions using Wu's algorithm, blending each pixel pair by coverage.
+    /// Only RGB565 and RGB565_BE targets are blended; other formats fall back to DrawLine().
+    void DrawLineAA(float x0, float y0, float x1, float y1, uint32_t color);
+
+    /// Draws the anti-aliased outline of a circle with a radius of up to 255 pixels.
+    /// Only RGB565 and RGB565_BE targets are blended; other formats fall back to DrawCircle().
+    void DrawCircleAA(int cx, int cy, int r, uint32_t color);
+
+    void DrawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color);
+
+    /// Draws a solid triangle as horizontal spans.
+    void FillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color);
+
+    /// Draws a solid polygon with any number of vertices, which may be concave or self-intersecting (using the even-odd rule).
+    void FillPolygon(const Point* vertices, int count, uint32_t color);
+
+    /// Draws a string in a baked font, with the top left of the first line at (x, y). Partial coverage is mixed between
+    /// fg and bg on RGB565 and RGB565_BE targets, so the text should be drawn over a background of the bg color.
+    void DrawText(const BakedFont* font, const char* text, int x, int y, uint16_t fg, uint16_t bg);
+
+    /// Expands the packed glyph rows of a string into runs of equal coverage, calling span(x, y, w, level) for each run
+    /// within the clip area. Levels range from 1 to (1 << font->bpp) - 1; empty pixels are skipped.
+    static void ScanText(const BakedFont* font, const char* text, int x, int y, IntRect clip, const std::function<void(int, int, int, uint8_t)>& span);
+
+    /// Scan converts a polygon using an active edge table in 16.16 fixed-point, calling span(x, y, w) for each horizontal run of
+    /// pixels within the clip area. Pixels are included when their centre is inside the polygon.
+    /// The edge tables are kept between calls, so once they have grown to fit, filling doesn't allocate.
+    template<typename Span>
+    void ScanPolygon(const Point* vertices, int count, IntRect clip, Span span);
+
+private:
+    /// Writes a single pixel without clipping.
+    void WritePixel(int x, int y, uint32_t color);
+
+    /// Blends a color in the target format over a pixel by 8-bit coverage, with clipping.
+    void BlendPixel(int x, int y, uint16_t color, uint32_t coverage);
+
+    /// Fills the edge table of a polygon with the edges crossing the rows of the clip area, sorted by their first scanline.
+    /// Returns false if there are none.
+    bool BuildEdgeTable(const Point* vertices, int count, IntRect clip);
+
+    /// Edges of the polygon being scan converted, and those crossing the current scanline.
+    std::vector<PolygonEdge> edges;
+    std::vector<PolygonEdge> activeEdges;
+
+    /// The surface drawn into.
+    BaseSurface* target = nullptr;
+
+    /// Area that drawing is restricted to, always within the target.
+    IntRect clip = {0, 0, 0, 0};
+
+};
+
+template<typename Span>
+void Rasterizer::ScanPolygon(const Point* vertices, int count, IntRect clip, Span span)
+{
+    if (count < 3 || clip.w <= 0 || clip.h <= 0 || !BuildEdgeTable(vertices, count, clip))
+    {
+        return;
+    }
+
+    activeEdges.clear();
+    unsigned int next = 0;
+    int clipRight = clip.x + clip.w;
+    int clipBottom = clip.y + clip.h;
+    for (int y = edges[0].startY; y < clipBottom && (next < edges.size() || !activeEdges.empty()); y++)
+    {
+        // Drop finished edges, then add those starting on this scanline.
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < activeEdges.size(); i++)
+        {
+            if (activeEdges[i].endY > y)
+            {
+                activeEdges[kept++] = activeEdges[i];
+            }
+        }
+        activeEdges.resize(kept);
+        while (next < edges.size() && edges[next].startY == y)
+        {
+            activeEdges.push_back(edges[next++]);
+        }
+
+        // Edges stay nearly sorted between scanlines, so insertion sort is cheap.
+        for (unsigned int i = 1; i < activeEdges.size(); i++)
+        {
+            PolygonEdge edge = activeEdges[i];
+            unsigned int j = i;
+            while (j > 0 && activeEdges[j - 1].x > edge.x)
+            {
+                activeEdges[j] = activeEdges[j - 1];
+                j--;
+            }
+            activeEdges[j] = edge;
+        }
+
+        // Fill between pairs of edges.
+        for (unsigned int i = 0; i + 1 < activeEdges.size(); i += 2)
+        {
+            // First and last pixel centres inside the span.
+            int left = max((activeEdges[i].x + 0x7FFF) >> 16, clip.x);
+            int right = min((activeEdges[i + 1].x + 0x7FFF) >> 16, clipRight);
+            if (left < right)
+            {
+                span(left, y, right - left);
+            }
+        }
+
+        for (unsigned int i = 0; i < activeEdges.size(); i++)
+        {
+            activeEdges[i].x += activeEdges[i].slope;
+        }
+    }
+}
+
+#endif // RASTERIZER_H
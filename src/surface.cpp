@@ -1,10 +1,679 @@
 #include <math.h>
+#include <utility>
+#include "color.h"
 #include "surface.h"
 
+// Lookup tables expanding 4, 5 and 6-bit channels to 8 bits.
+static const uint8_t expand4[16] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+};
+static const uint8_t expand5[32] = {
+    0x00, 0x08, 0x10, 0x18, 0x21, 0x29, 0x31, 0x39, 0x42, 0x4A, 0x52, 0x5A, 0x63, 0x6B, 0x73, 0x7B,
+    0x84, 0x8C, 0x94, 0x9C, 0xA5, 0xAD, 0xB5, 0xBD, 0xC6, 0xCE, 0xD6, 0xDE, 0xE7, 0xEF, 0xF7, 0xFF
+};
+static const uint8_t expand6[64] = {
+    0x00, 0x04, 0x08, 0x0C, 0x10, 0x14, 0x18, 0x1C, 0x20, 0x24, 0x28, 0x2C, 0x30, 0x34, 0x38, 0x3C,
+    0x41, 0x45, 0x49, 0x4D, 0x51, 0x55, 0x59, 0x5D, 0x61, 0x65, 0x69, 0x6D, 0x71, 0x75, 0x79, 0x7D,
+    0x82, 0x86, 0x8A, 0x8E, 0x92, 0x96, 0x9A, 0x9E, 0xA2, 0xA6, 0xAA, 0xAE, 0xB2, 0xB6, 0xBA, 0xBE,
+    0xC3, 0xC7, 0xCB, 0xCF, 0xD3, 0xD7, 0xDB, 0xDF, 0xE3, 0xE7, 0xEB, 0xEF, 0xF3, 0xF7, 0xFB, 0xFF
+};
+
+// Expands an RGB565 color to RGBA8888 with the given alpha.
+static inline uint32_t RGB565ToRGBA8888(uint16_t c, uint8_t alpha)
+{
+    return ((uint32_t)expand5[c >> 11] << 24) | ((uint32_t)expand6[(c >> 5) & 0x3F] << 16) | ((uint32_t)expand5[c & 0x1F] << 8) | alpha;
+}
+
+// Expands an RGBA4444 color to RGBA8888.
+static inline uint32_t RGBA4444ToRGBA8888(uint16_t c)
+{
+    return ((uint32_t)expand4[c >> 12] << 24) | ((uint32_t)expand4[(c >> 8) & 0xF] << 16) | ((uint32_t)expand4[(c >> 4) & 0xF] << 8) | expand4[c & 0xF];
+}
+
+// Reads a single pixel of any format as RGBA8888.
+static uint32_t ReadPixel(uint16_t format, const uint8_t* src)
+{
+    switch (format)
+    {
+    case PF_RGBA4444:
+        return RGBA4444ToRGBA8888(*((const uint16_t*)src));
+    case PF_RGBA5658:
+        return RGB565ToRGBA8888(src[0] | (src[1] << 8), src[2]);
+    case PF_RGBA8888:
+        return *((const uint32_t*)src);
+    case PF_RGB565_BE:
+        return RGB565ToRGBA8888(Swap565(*((const uint16_t*)src)), 0xFF);
+    case PF_RGB565:
+    default:
+        return RGB565ToRGBA8888(*((const uint16_t*)src), 0xFF);
+    }
+}
+
+// Writes a single RGBA8888 pixel in any format.
+static void WritePixel(uint16_t format, uint8_t* dest, uint32_t rgba)
+{
+    uint32_t r = rgba >> 24;
+    uint32_t g = (rgba >> 16) & 0xFF;
+    uint32_t b = (rgba >> 8) & 0xFF;
+    uint32_t a = rgba & 0xFF;
+    switch (format)
+    {
+    case PF_RGBA4444:
+        *((uint16_t*)dest) = ((r >> 4) << 12) | ((g >> 4) << 8) | ((b >> 4) << 4) | (a >> 4);
+        break;
+    case PF_RGBA5658:
+    {
+        uint16_t c = COLOR(r, g, b);
+        dest[0] = (uint8_t)c;
+        dest[1] = (uint8_t)(c >> 8);
+        dest[2] = (uint8_t)a;
+        break;
+    }
+    case PF_RGBA8888:
+        *((uint32_t*)dest) = rgba;
+        break;
+    case PF_RGB565_BE:
+        *((uint16_t*)dest) = Swap565(COLOR(r, g, b));
+        break;
+    case PF_RGB565:
+    default:
+        *((uint16_t*)dest) = COLOR(r, g, b);
+        break;
+    }
+}
+
+//
+// Row converters. The 16-bit kernels below work on a pair of pixels packed into a 32-bit word at a time;
+// the same function converts a lone pixel by passing it in the low half and discarding the high half.
+//
+
+static inline uint32_t RGB565PairToRGBA4444(uint32_t c)
+{
+    return (c & 0xF000F000) | ((c << 1) & 0x0F000F00) | ((c << 3) & 0x00F000F0) | 0x000F000F;
+}
+
+static inline uint32_t RGBA4444PairToRGB565(uint32_t c)
+{
+    return (c & 0xF000F000) | ((c >> 4) & 0x08000800)
+        | ((c >> 1) & 0x07800780) | ((c >> 5) & 0x00600060)
+        | ((c >> 3) & 0x001E001E) | ((c >> 7) & 0x00010001);
+}
+
+// Defines a converter between two 16-bit formats that handles two pixels per 32-bit word.
+// Both pointers need the same word alignment for the paired loop, otherwise the row is converted a pixel at a time.
+#define PAIRED_CONVERTER(NAME, PAIR)                                                        \
+static void NAME(const uint8_t* src, uint8_t* dest, uint32_t count)                         \
+{                                                                                           \
+    const uint16_t* in = (const uint16_t*)src;                                              \
+    uint16_t* out = (uint16_t*)dest;                                                        \
+    if ((((uintptr_t)in ^ (uintptr_t)out) & 3) == 0)                                        \
+    {                                                                                       \
+        if (count > 0 && ((uintptr_t)in & 3))                                               \
+        {                                                                                   \
+            *out++ = (uint16_t)PAIR(*in++);                                                 \
+            count--;                                                                        \
+        }                                                                                   \
+        const uint32_t* in32 = (const uint32_t*)in;                                         \
+        uint32_t* out32 = (uint32_t*)out;                                                   \
+        for (uint32_t i = 0, counti = count >> 1; i < counti; i++)                          \
+        {                                                                                   \
+            out32[i] = PAIR(in32[i]);                                                       \
+        }                                                                                   \
+        in += count & ~1u;                                                                  \
+        out += count & ~1u;                                                                 \
+        count &= 1;                                                                         \
+    }                                                                                       \
+    while (count--)                                                                         \
+    {                                                                                       \
+        *out++ = (uint16_t)PAIR(*in++);                                                     \
+    }                                                                                       \
+}
+
+// Swaps the bytes of each 16-bit half, between native and big-endian RGB565.
+static inline uint32_t SwapPair(uint32_t c)
+{
+    return ((c & 0x00FF00FF) << 8) | ((c >> 8) & 0x00FF00FF);
+}
+
+static inline uint32_t RGB565BEPairToRGBA4444(uint32_t c)
+{
+    return RGB565PairToRGBA4444(SwapPair(c));
+}
+
+static inline uint32_t RGBA4444PairToRGB565BE(uint32_t c)
+{
+    return SwapPair(RGBA4444PairToRGB565(c));
+}
+
+PAIRED_CONVERTER(ConvertRGB565ToRGBA4444, RGB565PairToRGBA4444)
+PAIRED_CONVERTER(ConvertRGBA4444ToRGB565, RGBA4444PairToRGB565)
+PAIRED_CONVERTER(SwapRGB565, SwapPair)
+PAIRED_CONVERTER(ConvertRGB565BEToRGBA4444, RGB565BEPairToRGBA4444)
+PAIRED_CONVERTER(ConvertRGBA4444ToRGB565BE, RGBA4444PairToRGB565BE)
+
+static void ConvertRGB565ToRGBA5658(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    const uint16_t* in = (const uint16_t*)src;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        dest[0] = (uint8_t)in[i];
+        dest[1] = (uint8_t)(in[i] >> 8);
+        dest[2] = 0xFF;
+        dest += 3;
+    }
+}
+
+static void ConvertRGBA5658ToRGB565(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    uint16_t* out = (uint16_t*)dest;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        out[i] = src[0] | (src[1] << 8);
+        src += 3;
+    }
+}
+
+static void ConvertRGB565ToRGBA8888(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    const uint16_t* in = (const uint16_t*)src;
+    uint32_t* out = (uint32_t*)dest;
+    if (count > 0 && ((uintptr_t)in & 3))
+    {
+        *out++ = RGB565ToRGBA8888(*in++, 0xFF);
+        count--;
+    }
+    // Read two source pixels per load.
+    const uint32_t* in32 = (const uint32_t*)in;
+    for (uint32_t i = 0, counti = count >> 1; i < counti; i++)
+    {
+        uint32_t pair = in32[i];
+        out[0] = RGB565ToRGBA8888((uint16_t)pair, 0xFF);
+        out[1] = RGB565ToRGBA8888((uint16_t)(pair >> 16), 0xFF);
+        out += 2;
+    }
+    if (count & 1)
+    {
+        *out = RGB565ToRGBA8888(in[count - 1], 0xFF);
+    }
+}
+
+static void ConvertRGBA8888ToRGB565(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    const uint32_t* in = (const uint32_t*)src;
+    uint16_t* out = (uint16_t*)dest;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t c = in[i];
+        out[i] = ((c >> 16) & 0xF800) | ((c >> 13) & 0x07E0) | ((c >> 11) & 0x001F);
+    }
+}
+
+static void ConvertRGBA4444ToRGBA8888(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    const uint16_t* in = (const uint16_t*)src;
+    uint32_t* out = (uint32_t*)dest;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        out[i] = RGBA4444ToRGBA8888(in[i]);
+    }
+}
+
+static void ConvertRGBA8888ToRGBA4444(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    const uint32_t* in = (const uint32_t*)src;
+    uint16_t* out = (uint16_t*)dest;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t c = in[i];
+        out[i] = ((c >> 16) & 0xF000) | ((c >> 12) & 0x0F00) | ((c >> 8) & 0x00F0) | ((c >> 4) & 0x000F);
+    }
+}
+
+// Converts a pair of formats without a dedicated kernel via RGBA8888.
+template<uint16_t SrcFormat, uint16_t DestFormat>
+static void ConvertGeneric(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    uint32_t srcDepth = GetDepth((PixelFormat)SrcFormat);
+    uint32_t destDepth = GetDepth((PixelFormat)DestFormat);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        WritePixel(DestFormat, dest, ReadPixel(SrcFormat, src));
+        src += srcDepth;
+        dest += destDepth;
+    }
+}
+
+typedef void (*RowConverter)(const uint8_t* src, uint8_t* dest, uint32_t count);
+
+// Returns the row of the converter table for a given format.
+static int GetConverterIndex(uint16_t format)
+{
+    switch (format)
+    {
+    case PF_RGB565:
+        return 0;
+    case PF_RGBA4444:
+        return 1;
+    case PF_RGBA5658:
+        return 2;
+    case PF_RGBA8888:
+        return 3;
+    case PF_RGB565_BE:
+        return 4;
+    default:
+        return -1;
+    }
+}
+
+// Converters indexed by [source][destination]. Conversions between identical formats are handled by the caller.
+static const RowConverter converters[5][5] = {
+    { nullptr, ConvertRGB565ToRGBA4444, ConvertRGB565ToRGBA5658, ConvertRGB565ToRGBA8888, SwapRGB565 },
+    { ConvertRGBA4444ToRGB565, nullptr, ConvertGeneric<PF_RGBA4444, PF_RGBA5658>, ConvertRGBA4444ToRGBA8888, ConvertRGBA4444ToRGB565BE },
+    { ConvertRGBA5658ToRGB565, ConvertGeneric<PF_RGBA5658, PF_RGBA4444>, nullptr, ConvertGeneric<PF_RGBA5658, PF_RGBA8888>, ConvertGeneric<PF_RGBA5658, PF_RGB565_BE> },
+    { ConvertRGBA8888ToRGB565, ConvertRGBA8888ToRGBA4444, ConvertGeneric<PF_RGBA8888, PF_RGBA5658>, nullptr, ConvertGeneric<PF_RGBA8888, PF_RGB565_BE> },
+    { SwapRGB565, ConvertRGB565BEToRGBA4444, ConvertGeneric<PF_RGB565_BE, PF_RGBA5658>, ConvertGeneric<PF_RGB565_BE, PF_RGBA8888>, nullptr }
+};
+
+bool ConvertPixels(uint16_t srcFormat, const void* src, uint16_t destFormat, void* dest, uint32_t count)
+{
+    if (IsIndexed(srcFormat) || IsIndexed(destFormat))
+    {
+        return false;
+    }
+    if (srcFormat == destFormat)
+    {
+        memmove(dest, src, count * GetDepth((PixelFormat)srcFormat));
+        return true;
+    }
+    int srcIndex = GetConverterIndex(srcFormat);
+    int destIndex = GetConverterIndex(destFormat);
+    if (srcIndex < 0 || destIndex < 0)
+    {
+        return false;
+    }
+    converters[srcIndex][destIndex]((const uint8_t*)src, (uint8_t*)dest, count);
+    return true;
+}
+
+//
+// Blenders composite a row of pixels with alpha over an RGB565 row, skipping transparent runs and copying opaque runs.
+//
+
+// Maps 4-bit alpha to a blend weight in the range [0, 32].
+static const uint8_t alpha4ToWeight[16] = {
+    0, 2, 4, 6, 9, 11, 13, 15, 17, 19, 21, 23, 26, 28, 30, 32
+};
+
+static void BlendRGBA4444ToRGB565(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    const uint16_t* in = (const uint16_t*)src;
+    uint16_t* out = (uint16_t*)dest;
+    uint32_t i = 0;
+    while (i < count)
+    {
+        uint32_t alpha = in[i] & 0xF;
+        if (alpha == 0)
+        {
+            do
+            {
+                i++;
+            } while (i < count && (in[i] & 0xF) == 0);
+        }
+        else if (alpha == 0xF)
+        {
+            do
+            {
+                out[i] = (uint16_t)RGBA4444PairToRGB565(in[i]);
+                i++;
+            } while (i < count && (in[i] & 0xF) == 0xF);
+        }
+        else
+        {
+            uint16_t color = (uint16_t)RGBA4444PairToRGB565(in[i]);
+            out[i] = Pack565(Lerp565(Expand565(out[i]), Expand565(color), alpha4ToWeight[alpha]));
+            i++;
+        }
+    }
+}
+
+static void BlendRGBA5658ToRGB565(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    uint16_t* out = (uint16_t*)dest;
+    uint32_t i = 0;
+    while (i < count)
+    {
+        uint32_t alpha = src[2];
+        if (alpha == 0)
+        {
+            do
+            {
+                i++;
+                src += 3;
+            } while (i < count && src[2] == 0);
+        }
+        else if (alpha == 0xFF)
+        {
+            do
+            {
+                out[i] = src[0] | (src[1] << 8);
+                i++;
+                src += 3;
+            } while (i < count && src[2] == 0xFF);
+        }
+        else
+        {
+            uint16_t color = src[0] | (src[1] << 8);
+            out[i] = Pack565(Lerp565(Expand565(out[i]), Expand565(color), (alpha + 4) >> 3));
+            i++;
+            src += 3;
+        }
+    }
+}
+
+static void BlendRGBA8888ToRGB565(const uint8_t* src, uint8_t* dest, uint32_t count)
+{
+    const uint32_t* in = (const uint32_t*)src;
+    uint16_t* out = (uint16_t*)dest;
+    uint32_t i = 0;
+    while (i < count)
+    {
+        uint32_t alpha = in[i] & 0xFF;
+        if (alpha == 0)
+        {
+            do
+            {
+                i++;
+            } while (i < count && (in[i] & 0xFF) == 0);
+        }
+        else if (alpha == 0xFF)
+        {
+            do
+            {
+                ConvertRGBA8888ToRGB565((const uint8_t*)&in[i], (uint8_t*)&out[i], 1);
+                i++;
+            } while (i < count && (in[i] & 0xFF) == 0xFF);
+        }
+        else
+        {
+            uint16_t color;
+            ConvertRGBA8888ToRGB565((const uint8_t*)&in[i], (uint8_t*)&color, 1);
+            out[i] = Pack565(Lerp565(Expand565(out[i]), Expand565(color), (alpha + 4) >> 3));
+            i++;
+        }
+    }
+}
+
+// Returns the blender for compositing a given format onto RGB565, or NULL if the format has no alpha channel.
+static RowConverter GetBlender(uint16_t srcFormat)
+{
+    switch (srcFormat)
+    {
+    case PF_RGBA4444:
+        return BlendRGBA4444ToRGB565;
+    case PF_RGBA5658:
+        return BlendRGBA5658ToRGB565;
+    case PF_RGBA8888:
+        return BlendRGBA8888ToRGB565;
+    default:
+        return nullptr;
+    }
+}
+
+//
+// Row fillers write a repeating pixel pattern with aligned 32-bit stores. The pattern is built once per call
+// rather than per pixel. The ESP32 has no 64-bit stores, so the word loops are unrolled instead.
+//
+
+typedef void (*RowFiller)(uint8_t* dest, uint32_t color, uint32_t count);
+
+// Fills a run of aligned words with the same value, four at a time.
+static inline void FillWords(uint32_t* out, uint32_t pattern, uint32_t count)
+{
+    uint32_t* end = out + (count & ~3u);
+    while (out < end)
+    {
+        out[0] = pattern;
+        out[1] = pattern;
+        out[2] = pattern;
+        out[3] = pattern;
+        out += 4;
+    }
+    for (uint32_t i = 0, counti = count & 3; i < counti; i++)
+    {
+        out[i] = pattern;
+    }
+}
+
+static void FillRow16(uint8_t* dest, uint32_t color, uint32_t count)
+{
+    uint16_t* out = (uint16_t*)dest;
+    if (count > 0 && ((uintptr_t)out & 3))
+    {
+        *out++ = (uint16_t)color;
+        count--;
+    }
+    FillWords((uint32_t*)out, (color & 0xFFFF) | (color << 16), count >> 1);
+    if (count & 1)
+    {
+        out[count - 1] = (uint16_t)color;
+    }
+}
+
+static void FillRow24(uint8_t* dest, uint32_t color, uint32_t count)
+{
+    uint8_t bytes[3] = { (uint8_t)color, (uint8_t)(color >> 8), (uint8_t)(color >> 16) };
+
+    // Write single pixels until word aligned, at most three.
+    while (count > 0 && ((uintptr_t)dest & 3))
+    {
+        dest[0] = bytes[0];
+        dest[1] = bytes[1];
+        dest[2] = bytes[2];
+        dest += 3;
+        count--;
+    }
+
+    // Four pixels span exactly three words.
+    uint8_t patternBytes[12];
+    for (int i = 0; i < 12; i++)
+    {
+        patternBytes[i] = bytes[i % 3];
+    }
+    uint32_t pattern[3];
+    memcpy(pattern, patternBytes, sizeof(pattern));
+
+    uint32_t* out = (uint32_t*)dest;
+    for (uint32_t i = 0, counti = count >> 2; i < counti; i++)
+    {
+        out[0] = pattern[0];
+        out[1] = pattern[1];
+        out[2] = pattern[2];
+        out += 3;
+    }
+
+    dest = (uint8_t*)out;
+    for (uint32_t i = 0, counti = count & 3; i < counti; i++)
+    {
+        dest[0] = bytes[0];
+        dest[1] = bytes[1];
+        dest[2] = bytes[2];
+        dest += 3;
+    }
+}
+
+static void FillRow32(uint8_t* dest, uint32_t color, uint32_t count)
+{
+    FillWords((uint32_t*)dest, color, count);
+}
+
+//
+// Indexed pixels are addressed by column rather than byte, as PF_INDEX4 packs two pixels into each byte.
+//
+
+// Reads the palette index of the pixel at column x of a row.
+static inline uint8_t ReadIndex(uint16_t format, const uint8_t* row, uint32_t x)
+{
+    if (format == PF_INDEX8)
+    {
+        return row[x];
+    }
+    uint8_t pair = row[x >> 1];
+    return (x & 1) ? (pair & 0xF) : (pair >> 4);
+}
+
+// Writes the palette index of the pixel at column x of a row.
+static inline void WriteIndex(uint16_t format, uint8_t* row, uint32_t x, uint8_t index)
+{
+    if (format == PF_INDEX8)
+    {
+        row[x] = index;
+        return;
+    }
+    uint8_t* pair = &row[x >> 1];
+    *pair = (x & 1) ? ((*pair & 0xF0) | (index & 0xF)) : ((*pair & 0x0F) | (index << 4));
+}
+
+// Fills count pixels of a row from column x with the same index.
+static void FillIndices(uint16_t format, uint8_t* row, uint32_t x, uint8_t index, uint32_t count)
+{
+    if (format == PF_INDEX8)
+    {
+        memset(row + x, index, count);
+        return;
+    }
+    index &= 0xF;
+    if ((x & 1) && count > 0)
+    {
+        WriteIndex(format, row, x++, index);
+        count--;
+    }
+    memset(row + (x >> 1), (index << 4) | index, count >> 1);
+    if (count & 1)
+    {
+        WriteIndex(format, row, x + count - 1, index);
+    }
+}
+
+// Copies count indices from column srcX of one row to column destX of another, which may be the same row.
+static void CopyIndices(uint16_t format, const uint8_t* srcRow, uint32_t srcX, uint8_t* destRow, uint32_t destX, uint32_t count)
+{
+    if (format == PF_INDEX8)
+    {
+        memmove(destRow + destX, srcRow + srcX, count);
+        return;
+    }
+    if (((srcX ^ destX) & 1) == 0)
+    {
+        // Both start on the same half of a byte, so whole bytes can be copied between the ends.
+        if ((srcX & 1) && count > 0)
+        {
+            WriteIndex(format, destRow, destX++, ReadIndex(format, srcRow, srcX++));
+            count--;
+        }
+        memmove(destRow + (destX >> 1), srcRow + (srcX >> 1), count >> 1);
+        if (count & 1)
+        {
+            WriteIndex(format, destRow, destX + count - 1, ReadIndex(format, srcRow, srcX + count - 1));
+        }
+        return;
+    }
+    // Copy backwards when moving right within the same row, so pixels aren't overwritten before they're read.
+    if (srcRow == destRow && destX > srcX)
+    {
+        for (uint32_t i = count; i > 0; i--)
+        {
+            WriteIndex(format, destRow, destX + i - 1, ReadIndex(format, srcRow, srcX + i - 1));
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        WriteIndex(format, destRow, destX + i, ReadIndex(format, srcRow, srcX + i));
+    }
+}
+
+// Expands count indices from column x of a row to RGB565 through a palette.
+static void ExpandIndices(uint16_t format, const uint8_t* row, uint32_t x, const uint16_t* palette, uint16_t* out, uint32_t count)
+{
+    if (format == PF_INDEX8)
+    {
+        row += x;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            out[i] = palette[row[i]];
+        }
+        return;
+    }
+    const uint8_t* in = row + (x >> 1);
+    if ((x & 1) && count > 0)
+    {
+        *out++ = palette[*in++ & 0xF];
+        count--;
+    }
+    // Two pixels per byte.
+    for (uint32_t i = 0, counti = count >> 1; i < counti; i++)
+    {
+        uint8_t pair = *in++;
+        out[0] = palette[pair >> 4];
+        out[1] = palette[pair & 0xF];
+        out += 2;
+    }
+    if (count & 1)
+    {
+        *out = palette[*in >> 4];
+    }
+}
+
+// Clips a pair of equally sized blit areas against the source and destination surface dimensions.
+// Returns false if there is nothing left to draw.
+static bool ClipBlit(IntRect& src, IntRect& dest, int srcWidth, int srcHeight, int destWidth, int destHeight)
+{
+    // Clip the source area, shifting the destination area along with it.
+    if (src.x < 0)
+    {
+        dest.x -= src.x;
+        src.w += src.x;
+        src.x = 0;
+    }
+    if (src.y < 0)
+    {
+        dest.y -= src.y;
+        src.h += src.y;
+        src.y = 0;
+    }
+    src.w = min(src.w, srcWidth - src.x);
+    src.h = min(src.h, srcHeight - src.y);
+    dest.w = src.w;
+    dest.h = src.h;
+
+    // Now do the same for the destination area.
+    if (dest.x < 0)
+    {
+        src.x -= dest.x;
+        dest.w += dest.x;
+        dest.x = 0;
+    }
+    if (dest.y < 0)
+    {
+        src.y -= dest.y;
+        dest.h += dest.y;
+        dest.y = 0;
+    }
+    dest.w = min(dest.w, destWidth - dest.x);
+    dest.h = min(dest.h, destHeight - dest.y);
+    src.w = dest.w;
+    src.h = dest.h;
+
+    return dest.w > 0 && dest.h > 0;
+}
+
 uint8_t GetDepth(PixelFormat format)
 {
     switch (format)
     {
+    case PF_INDEX4:
+    case PF_INDEX8:
+        return 1;
     case PF_RGBA5658:
         return 3;
     case PF_RGBA8888:
@@ -16,26 +685,61 @@ uint8_t GetDepth(PixelFormat format)
     }
 }
 
-void Surface::Init(uint32_t w, uint32_t h, uint8_t format, bool usePSRAM)
+uint8_t GetBitsPerPixel(PixelFormat format)
+{
+    return format == PF_INDEX4 ? 4 : GetDepth(format) * 8;
+}
+
+bool IsIndexed(uint16_t format)
+{
+    return format == PF_INDEX4 || format == PF_INDEX8;
+}
+
+void Surface::Init(uint32_t w, uint32_t h, uint8_t format, uint8_t placement)
 {
     this->format = format;
-    uint32_t depth = GetDepth((PixelFormat)format);
-    pitch = depth * w;
-    pixels = usePSRAM ? ps_malloc(pitch * h) : malloc(pitch * h);
+    pitch = ((GetBitsPerPixel((PixelFormat)format) * w) + 7) / 8;
+    pixels = SurfacePool::Allocate(pitch * h, placement, &this->placement);
     if (pixels == NULL)
     {
         LogError("Failed to allocate memory for surface!\n");
+        return;
     }
-    else
+    this->w = w;
+    this->h = h;
+    if (IsIndexed(format))
     {
-        this->w = w;
-        this->h = h;
+        // Starts out black.
+        palette = new uint16_t[GetPaletteSize()]();
     }
 }
 
 void Surface::Destroy()
 {
-    free(pixels);
+    SurfacePool::Free(pixels, pitch * h, placement);
+    delete[] palette;
+    palette = nullptr;
+    pixels = nullptr;
+    w = 0;
+    h = 0;
+}
+
+void Surface::Swap(Surface* other)
+{
+    std::swap(pixels, other->pixels);
+    std::swap(pitch, other->pitch);
+    std::swap(format, other->format);
+    std::swap(palette, other->palette);
+    std::swap(scaleMode, other->scaleMode);
+    std::swap(blendMode, other->blendMode);
+    std::swap(w, other->w);
+    std::swap(h, other->h);
+    std::swap(placement, other->placement);
+}
+
+uint8_t Surface::GetPlacement()
+{
+    return placement;
 }
 
 void* BaseSurface::GetPixels()
@@ -48,6 +752,26 @@ uint32_t BaseSurface::GetPitch()
     return pitch;
 }
 
+void BaseSurface::SetScaleMode(ScaleMode mode)
+{
+    scaleMode = mode;
+}
+
+ScaleMode BaseSurface::GetScaleMode()
+{
+    return (ScaleMode)scaleMode;
+}
+
+void BaseSurface::SetBlendMode(BlendMode mode)
+{
+    blendMode = mode;
+}
+
+BlendMode BaseSurface::GetBlendMode()
+{
+    return (BlendMode)blendMode;
+}
+
 uint16_t BaseSurface::GetFormat()
 {
     return format;
@@ -63,79 +787,599 @@ uint32_t BaseSurface::GetHeight()
     return h;
 }
 
+uint16_t* BaseSurface::GetPalette()
+{
+    return palette;
+}
+
+uint16_t BaseSurface::GetPaletteSize()
+{
+    return format == PF_INDEX4 ? 16 : (format == PF_INDEX8 ? 256 : 0);
+}
+
+void BaseSurface::SetPalette(const uint16_t* colors, uint16_t count, uint16_t first)
+{
+    if (palette == nullptr || first >= GetPaletteSize())
+    {
+        return;
+    }
+    count = min(count, (uint16_t)(GetPaletteSize() - first));
+    memcpy(palette + first, colors, count * sizeof(uint16_t));
+}
+
+void BaseSurface::ExpandIndexed(int x, int y, uint32_t count, uint16_t* out)
+{
+    if (palette != nullptr && pixels != nullptr)
+    {
+        ExpandIndices(format, (const uint8_t*)pixels + (y * pitch), x, palette, out, count);
+    }
+}
+
 void BaseSurface::Replicate(BaseSurface* other)
 {
     if (w == other->w && h == other->h && format == other->format && pixels && other->pixels)
     {
-        for (unsigned int i = 0, counti = pitch * h; i < counti; i += 2)
+        if (pitch == other->pitch)
+        {
+            memcpy(pixels, other->pixels, pitch * h);
+        }
+        else
         {
-            ((uint16_t*)pixels)[i] = ((uint16_t*)other->pixels)[i];
+            Replicate(other, (IntRect){0, 0, (int)w, (int)h});
         }
     }
 }
 
-/*
-Surface* Surface::ConvertTo(uint16_t format)
+void BaseSurface::Replicate(BaseSurface* other, IntRect area)
 {
-    Surface* created = nullptr;
+    if (format != other->format || pixels == nullptr || other->pixels == nullptr)
+    {
+        return;
+    }
 
-    created = new Surface(pixels, pitch, format);
-    // TODO: implement support for different formats
-    if (this->format != format)
+    // Clip to both surfaces.
+    if (area.x < 0)
     {
-        void* converted = new
-        created = new Surface();
+        area.w += area.x;
+        area.x = 0;
     }
-    else
+    if (area.y < 0)
+    {
+        area.h += area.y;
+        area.y = 0;
+    }
+    area.w = min(area.w, (int)min(w, other->w) - area.x);
+    area.h = min(area.h, (int)min(h, other->h) - area.y);
+    if (area.w <= 0 || area.h <= 0)
+    {
+        return;
+    }
+
+    if (format == PF_INDEX4)
+    {
+        for (int i = 0; i < area.h; i++)
+        {
+            CopyIndices(format, (const uint8_t*)other->pixels + ((area.y + i) * other->pitch), area.x, (uint8_t*)pixels + ((area.y + i) * pitch), area.x, area.w);
+        }
+        return;
+    }
+
+    uint32_t depth = GetDepth((PixelFormat)format);
+    uint32_t rowBytes = area.w * depth;
+    uint8_t* destRow = (uint8_t*)pixels + (area.y * pitch) + (area.x * depth);
+    const uint8_t* srcRow = (const uint8_t*)other->pixels + (area.y * other->pitch) + (area.x * depth);
+    if (rowBytes == pitch && pitch == other->pitch)
     {
-        created = new Surface(pixels, pitch, format);
+        memcpy(destRow, srcRow, rowBytes * area.h);
+        return;
+    }
+    for (int i = 0; i < area.h; i++)
+    {
+        memcpy(destRow, srcRow, rowBytes);
+        destRow += pitch;
+        srcRow += other->pitch;
+    }
+}
+
+#ifdef SURFACE_DMA_COPY
+// Async memcpy driver, installed on first use.
+static async_memcpy_t copyDriver = nullptr;
+// Given by the DMA interrupt once the outstanding copy completes.
+static SemaphoreHandle_t copyDone = nullptr;
+// Whether a copy is in flight.
+static volatile bool copyPending = false;
+
+static bool IRAM_ATTR OnCopyDone(async_memcpy_t driver, async_memcpy_event_t* event, void* args)
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(copyDone, &woken);
+    return woken == pdTRUE;
+}
+#endif // SURFACE_DMA_COPY
+
+void BaseSurface::ReplicateAsync(BaseSurface* other)
+{
+#ifdef SURFACE_DMA_COPY
+    if (w == other->w && h == other->h && format == other->format && pitch == other->pitch && pixels && other->pixels)
+    {
+        if (copyDriver == nullptr)
+        {
+            async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+            copyDone = xSemaphoreCreateBinary();
+            if (esp_async_memcpy_install(&config, &copyDriver) != ESP_OK)
+            {
+                copyDriver = nullptr;
+                LogError("Failed to install async memcpy driver!");
+            }
+        }
+
+        // Only one copy may be in flight at a time.
+        WaitReplicate();
+        if (copyDriver != nullptr)
+        {
+            copyPending = true;
+            if (esp_async_memcpy(copyDriver, pixels, other->pixels, pitch * h, OnCopyDone, nullptr) == ESP_OK)
+            {
+                return;
+            }
+            copyPending = false;
+        }
+    }
+#endif // SURFACE_DMA_COPY
+    Replicate(other);
+}
+
+void BaseSurface::WaitReplicate()
+{
+#ifdef SURFACE_DMA_COPY
+    if (copyPending)
+    {
+        xSemaphoreTake(copyDone, portMAX_DELAY);
+        copyPending = false;
+    }
+#endif // SURFACE_DMA_COPY
+}
+
+Surface* BaseSurface::ConvertTo(uint16_t format)
+{
+    if (pixels == nullptr || GetConverterIndex(format) < 0)
+    {
+        return nullptr;
+    }
+
+    Surface* created = new Surface();
+    created->Init(w, h, format);
+    if (created->pixels == nullptr)
+    {
+        delete created;
+        return nullptr;
+    }
+
+    if (IsIndexed(this->format))
+    {
+        // Expanded through the palette.
+        BlitIndexed(created, (IntRect){0, 0, (int)w, (int)h}, (IntRect){0, 0, (int)w, (int)h});
+        return created;
+    }
+
+    const uint8_t* srcRow = (const uint8_t*)pixels;
+    uint8_t* destRow = (uint8_t*)created->pixels;
+    for (uint32_t i = 0; i < h; i++)
+    {
+        ConvertPixels(this->format, srcRow, format, destRow, w);
+        srcRow += pitch;
+        destRow += created->pitch;
     }
     return created;
 }
-*/
+
+bool BaseSurface::ConvertInPlace(uint16_t format)
+{
+    if (pixels == nullptr || GetConverterIndex(format) < 0 || GetDepth((PixelFormat)format) != GetDepth((PixelFormat)this->format))
+    {
+        return false;
+    }
+
+    // Each converted pixel occupies the same bytes it was read from, so rows can be converted over themselves.
+    uint8_t* row = (uint8_t*)pixels;
+    for (uint32_t i = 0; i < h; i++)
+    {
+        ConvertPixels(this->format, row, format, row, w);
+        row += pitch;
+    }
+    this->format = format;
+    return true;
+}
 
 void BaseSurface::Clear(uint32_t color)
 {
-    uint8_t depth = GetDepth((PixelFormat)format);
-    switch (depth)
+    FillRect((IntRect){0, 0, (int)w, (int)h}, color);
+}
+
+void BaseSurface::FillRect(IntRect rect, uint32_t color)
+{
+    if (pixels == nullptr)
     {
-    default:
-        // Default to 16-bit.
-        // TODO: support other formats
-        for (uint32_t i = 0, counti = pitch * h; i < counti; i += 2)
+        return;
+    }
+
+    // Clip to the surface.
+    if (rect.x < 0)
+    {
+        rect.w += rect.x;
+        rect.x = 0;
+    }
+    if (rect.y < 0)
+    {
+        rect.h += rect.y;
+        rect.y = 0;
+    }
+    rect.w = min(rect.w, (int)w - rect.x);
+    rect.h = min(rect.h, (int)h - rect.y);
+    if (rect.w <= 0 || rect.h <= 0)
+    {
+        return;
+    }
+
+    if (IsIndexed(format))
+    {
+        uint8_t* row = (uint8_t*)pixels + (rect.y * pitch);
+        for (int i = 0; i < rect.h; i++)
         {
-            ((uint8_t*)pixels)[i + 1] = (uint8_t)(color & 0x000000FF);
-            ((uint8_t*)pixels)[i] = (uint8_t)(color >> 8);
+            FillIndices(format, row, rect.x, (uint8_t)color, rect.w);
+            row += pitch;
+        }
+        return;
+    }
+
+    uint32_t depth = GetDepth((PixelFormat)format);
+    RowFiller fill = depth == 4 ? FillRow32 : (depth == 3 ? FillRow24 : FillRow16);
+    uint8_t* row = (uint8_t*)pixels + (rect.y * pitch) + (rect.x * depth);
+
+    if ((uint32_t)rect.w * depth == pitch)
+    {
+        // Full width rows are contiguous, fill them all in one go.
+        fill(row, color, rect.w * rect.h);
+    }
+    else
+    {
+        for (int i = 0; i < rect.h; i++)
+        {
+            fill(row, color, rect.w);
+            row += pitch;
         }
-        break;
     }
 }
-/*
-void Surface::Blit(Surface* dest, IntRect* destRect, IntRect* srcRect)
+
+void BaseSurface::Blit(BaseSurface* dest, IntRect* destRect, IntRect* srcRect)
 {
-    bool didConvert = false;
-    Surface* converted = this;
-    if (format != dest->format)
+    if (dest == nullptr || pixels == nullptr || dest->pixels == nullptr)
     {
-        // First, make sure the surfaces are the same format
-        converted = ConvertTo(dest->format);
-        didConvert = true;
+        return;
     }
 
-    // Now both are the same format, locate the starting position in the destination surface for each row and blit across.
-    uint32_t depth = GetDepth((PixelFormat)format);
+    IntRect src = srcRect != nullptr ? *srcRect : (IntRect){0, 0, (int)w, (int)h};
+    IntRect area = destRect != nullptr ? *destRect : (IntRect){0, 0, src.w, src.h};
+
+    if (area.w != src.w || area.h != src.h)
+    {
+        BlitScaled(dest, area, src);
+        return;
+    }
+
+    if (!ClipBlit(src, area, (int)w, (int)h, (int)dest->w, (int)dest->h))
+    {
+        return;
+    }
+
+    if (IsIndexed(format))
+    {
+        BlitIndexed(dest, area, src);
+        return;
+    }
+    if (IsIndexed(dest->format))
+    {
+        return;
+    }
+
+    uint32_t srcDepth = GetDepth((PixelFormat)format);
+    uint32_t destDepth = GetDepth((PixelFormat)dest->format);
+    const uint8_t* srcRow = (const uint8_t*)pixels + (src.y * pitch) + (src.x * srcDepth);
+    uint8_t* destRow = (uint8_t*)dest->pixels + (area.y * dest->pitch) + (area.x * destDepth);
+
+    bool swapped = dest->format == PF_RGB565_BE;
+    RowConverter blender = blendMode == BLENDMODE_BLEND && (dest->format == PF_RGB565 || swapped) ? GetBlender(format) : nullptr;
+    if (blender != nullptr)
+    {
+        for (int i = 0; i < area.h; i++)
+        {
+            // Blenders work in native order, so a big-endian row is swapped around them.
+            if (swapped)
+            {
+                SwapRGB565(destRow, destRow, area.w);
+            }
+            blender(srcRow, destRow, area.w);
+            if (swapped)
+            {
+                SwapRGB565(destRow, destRow, area.w);
+            }
+            srcRow += pitch;
+            destRow += dest->pitch;
+        }
+    }
+    else if (format == dest->format)
+    {
+        uint32_t rowBytes = area.w * srcDepth;
+        if (dest == this)
+        {
+            // Blitting onto ourself, rows may overlap so copy from the bottom up when moving downwards.
+            int32_t step = (int32_t)pitch;
+            if (area.y > src.y)
+            {
+                srcRow += (area.h - 1) * pitch;
+                destRow += (area.h - 1) * pitch;
+                step = -step;
+            }
+            for (int i = 0; i < area.h; i++)
+            {
+                memmove(destRow, srcRow, rowBytes);
+                srcRow += step;
+                destRow += step;
+            }
+        }
+        else if (rowBytes == pitch && rowBytes == dest->pitch)
+        {
+            // Both areas are contiguous, copy the whole block at once.
+            memcpy(destRow, srcRow, rowBytes * area.h);
+        }
+        else
+        {
+            for (int i = 0; i < area.h; i++)
+            {
+                memcpy(destRow, srcRow, rowBytes);
+                srcRow += pitch;
+                destRow += dest->pitch;
+            }
+        }
+    }
+    else
+    {
+        // Differing formats, convert each row on the fly.
+        for (int i = 0; i < area.h; i++)
+        {
+            ConvertPixels(format, srcRow, dest->format, destRow, area.w);
+            srcRow += pitch;
+            destRow += dest->pitch;
+        }
+    }
+}
 
-    uint32_t step = ((uint32_t)max(destRect->x, 0)) * depth;
-    for (uint32_t i = (uint32_t)(destRect->y * pitch) + step; i < pitch * dest->w * dest->h; i += step)
+void BaseSurface::BlitIndexed(BaseSurface* dest, IntRect area, IntRect src)
+{
+    const uint8_t* srcRow = (const uint8_t*)pixels + (src.y * pitch);
+    if (dest->format == format)
     {
-        //uint32_t stopIndex = (uint32_t)(destRect->x * depth)
+        // Indices are copied as they are, so they take on the palette of the destination.
+        uint8_t* destRow = (uint8_t*)dest->pixels + (area.y * dest->pitch);
+        int32_t srcStep = (int32_t)pitch;
+        int32_t destStep = (int32_t)dest->pitch;
+        if (dest == this && area.y > src.y)
+        {
+            // Rows may overlap, so copy from the bottom up when moving downwards.
+            srcRow += (area.h - 1) * pitch;
+            destRow += (area.h - 1) * dest->pitch;
+            srcStep = -srcStep;
+            destStep = -destStep;
+        }
+        for (int i = 0; i < area.h; i++)
+        {
+            CopyIndices(format, srcRow, src.x, destRow, area.x, area.w);
+            srcRow += srcStep;
+            destRow += destStep;
+        }
+        return;
+    }
+    if (IsIndexed(dest->format) || palette == nullptr)
+    {
+        return;
     }
 
-    if (didConvert)
+    uint32_t destDepth = GetDepth((PixelFormat)dest->format);
+    uint8_t* destRow = (uint8_t*)dest->pixels + (area.y * dest->pitch) + (area.x * destDepth);
+    for (int i = 0; i < area.h; i++)
     {
-        // Once done, we can free the converted surface copy.
-        delete converted;
+        if (dest->format == PF_RGB565)
+        {
+            ExpandIndices(format, srcRow, src.x, palette, (uint16_t*)destRow, area.w);
+        }
+        else
+        {
+            // Expand to RGB565 a chunk at a time, then convert.
+            uint16_t chunk[64];
+            for (int done = 0; done < area.w; done += 64)
+            {
+                int count = min(area.w - done, 64);
+                ExpandIndices(format, srcRow, src.x + done, palette, chunk, count);
+                ConvertPixels(PF_RGB565, chunk, dest->format, destRow + (done * destDepth), count);
+            }
+        }
+        srcRow += pitch;
+        destRow += dest->pitch;
     }
 }
-*/
 
+void BaseSurface::BlitScaled(BaseSurface* dest, IntRect area, IntRect src)
+{
+    // Only the source area is clipped here, the destination is clipped per-pixel below so the scale stays intact.
+    if (src.x < 0)
+    {
+        src.w += src.x;
+        src.x = 0;
+    }
+    if (src.y < 0)
+    {
+        src.h += src.y;
+        src.y = 0;
+    }
+    src.w = min(src.w, (int)w - src.x);
+    src.h = min(src.h, (int)h - src.y);
+    if (src.w <= 0 || src.h <= 0 || area.w <= 0 || area.h <= 0)
+    {
+        return;
+    }
+
+    int startX = max(area.x, 0);
+    int startY = max(area.y, 0);
+    int endX = min(area.x + area.w, (int)dest->w);
+    int endY = min(area.y + area.h, (int)dest->h);
+    if (startX >= endX || startY >= endY)
+    {
+        return;
+    }
+
+    // 16.16 fixed-point steps through the source area per destination pixel, sampling at pixel centres.
+    uint32_t stepX = ((uint32_t)src.w << 16) / area.w;
+    uint32_t stepY = ((uint32_t)src.h << 16) / area.h;
+    uint32_t startU = ((startX - area.x) * stepX) + (stepX >> 1);
+    uint32_t v = ((startY - area.y) * stepY) + (stepY >> 1);
+
+    if (IsIndexed(format) || IsIndexed(dest->format))
+    {
+        // Nearest neighbour only, between the same indexed format or from an indexed format through the palette.
+        if (format != dest->format && (IsIndexed(dest->format) || palette == nullptr))
+        {
+            return;
+        }
+        uint32_t destDepth = GetDepth((PixelFormat)dest->format);
+        for (int y = startY; y < endY; y++)
+        {
+            const uint8_t* srcRow = (const uint8_t*)pixels + ((src.y + (v >> 16)) * pitch);
+            uint8_t* destRow = (uint8_t*)dest->pixels + (y * dest->pitch);
+            uint32_t u = startU;
+            for (int x = startX; x < endX; x++)
+            {
+                uint8_t index = ReadIndex(format, srcRow, src.x + (u >> 16));
+                if (format == dest->format)
+                {
+                    WriteIndex(format, destRow, x, index);
+                }
+                else
+                {
+                    WritePixel(dest->format, destRow + (x * destDepth), RGB565ToRGBA8888(palette[index], 0xFF));
+                }
+                u += stepX;
+            }
+            v += stepY;
+        }
+        return;
+    }
+
+    uint32_t srcDepth = GetDepth((PixelFormat)format);
+    uint32_t destDepth = GetDepth((PixelFormat)dest->format);
+    const uint8_t* srcOrigin = (const uint8_t*)pixels + (src.y * pitch) + (src.x * srcDepth);
+    uint8_t* destRow = (uint8_t*)dest->pixels + (startY * dest->pitch) + (startX * destDepth);
+    int count = endX - startX;
+
+    bool swapped = dest->format == PF_RGB565_BE;
+    if (scaleMode == SCALEMODE_BILINEAR && format == PF_RGB565 && (dest->format == PF_RGB565 || swapped))
+    {
+        for (int y = startY; y < endY; y++)
+        {
+            // Offset by half a pixel so the weights are relative to the neighbouring pixel centres.
+            int32_t sy = max((int32_t)v - 0x8000, (int32_t)0);
+            int row = sy >> 16;
+            uint32_t weightY = (sy >> 11) & 0x1F;
+            const uint16_t* top = (const uint16_t*)(srcOrigin + (row * pitch));
+            const uint16_t* bottom = (const uint16_t*)(srcOrigin + (min(row + 1, src.h - 1) * pitch));
+
+            uint16_t* out = (uint16_t*)destRow;
+            uint32_t u = startU;
+            for (int i = 0; i < count; i++)
+            {
+                int32_t sx = max((int32_t)u - 0x8000, (int32_t)0);
+                int col = sx >> 16;
+                int nextCol = min(col + 1, src.w - 1);
+                uint32_t weightX = (sx >> 11) & 0x1F;
+
+                uint32_t upper = Lerp565(Expand565(top[col]), Expand565(top[nextCol]), weightX);
+                uint32_t lower = Lerp565(Expand565(bottom[col]), Expand565(bottom[nextCol]), weightX);
+                uint16_t color = Pack565(Lerp565(upper, lower, weightY));
+                out[i] = swapped ? Swap565(color) : color;
+                u += stepX;
+            }
+
+            v += stepY;
+            destRow += dest->pitch;
+        }
+        return;
+    }
+
+    // Nearest neighbour
+    RowConverter blender = blendMode == BLENDMODE_BLEND && (dest->format == PF_RGB565 || swapped) ? GetBlender(format) : nullptr;
+    for (int y = startY; y < endY; y++)
+    {
+        const uint8_t* srcRow = srcOrigin + ((v >> 16) * pitch);
+        uint32_t u = startU;
+        if (blender != nullptr)
+        {
+            // Blenders work in native order, so a big-endian row is swapped around them.
+            if (swapped)
+            {
+                SwapRGB565(destRow, destRow, count);
+            }
+            uint8_t* destPixel = destRow;
+            for (int i = 0; i < count; i++)
+            {
+                blender(srcRow + ((u >> 16) * srcDepth), destPixel, 1);
+                destPixel += destDepth;
+                u += stepX;
+            }
+            if (swapped)
+            {
+                SwapRGB565(destRow, destRow, count);
+            }
+        }
+        else if (format != dest->format)
+        {
+            uint8_t* destPixel = destRow;
+            for (int i = 0; i < count; i++)
+            {
+                WritePixel(dest->format, destPixel, ReadPixel(format, srcRow + ((u >> 16) * srcDepth)));
+                destPixel += destDepth;
+                u += stepX;
+            }
+        }
+        else if (srcDepth == 2)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                ((uint16_t*)destRow)[i] = ((const uint16_t*)srcRow)[u >> 16];
+                u += stepX;
+            }
+        }
+        else if (srcDepth == 4)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                ((uint32_t*)destRow)[i] = ((const uint32_t*)srcRow)[u >> 16];
+                u += stepX;
+            }
+        }
+        else
+        {
+            uint8_t* destPixel = destRow;
+            for (int i = 0; i < count; i++)
+            {
+                const uint8_t* srcPixel = srcRow + ((u >> 16) * srcDepth);
+                destPixel[0] = srcPixel[0];
+                destPixel[1] = srcPixel[1];
+                destPixel[2] = srcPixel[2];
+                destPixel += 3;
+                u += stepX;
+            }
+        }
+
+        v += stepY;
+        destRow += dest->pitch;
+    }
+}
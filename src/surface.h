@@ -2,20 +2,69 @@
 #define SURFACE_H
 
 #include "color.h"
+#include "coremaths.h"
 #include "utils.h"
-
+#include "surfacepool.h"
+
+// Uncomment to use the async memcpy DMA engine for BaseSurface::ReplicateAsync().
+// Only available on chips with GDMA (e.g. ESP32-S3), not the original ESP32; both surfaces must be in DMA-capable memory.
+//#define SURFACE_DMA_COPY
+
+#ifdef SURFACE_DMA_COPY
+#include "esp_async_memcpy.h"
+#endif // SURFACE_DMA_COPY
+
+// Pixel layouts, all stored in native byte order except PF_RGB565_BE:
+// PF_RGB565   - 16-bit RRRRRGGGGGGBBBBB.
+// PF_RGBA4444 - 16-bit RRRRGGGGBBBBAAAA.
+// PF_RGBA5658 - 16-bit RGB565 followed by an 8-bit alpha byte.
+// PF_RGBA8888 - 32-bit RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA.
+// PF_INDEX4   - 4-bit index into a 16 color RGB565 palette, two pixels per byte with the leftmost in the high nibble.
+// PF_INDEX8   - 8-bit index into a 256 color RGB565 palette.
+// PF_RGB565_BE - 16-bit RGB565 stored high byte first, the order the panel expects, so it can be sent without swapping.
 enum PixelFormat
 {
     PF_RGB565   =   0x0000,
     PF_RGBA4444 =   0x0001,
     PF_RGBA5658 =   0x0002,
     PF_RGBA8888 =   0x0004,
+    PF_INDEX4   =   0x0008,
+    PF_INDEX8   =   0x0010,
+    PF_RGB565_BE =  0x0020,
     PF_UNKNOWN  =   0xFFFF
 };
 
-// Returns the number of bytes used in a given pixel format.
+// Filtering used when blitting to an area of differing dimensions.
+enum ScaleMode
+{
+    SCALEMODE_NEAREST = 0,
+    SCALEMODE_BILINEAR
+};
+
+// How pixels are combined with the destination when blitting.
+enum BlendMode
+{
+    // Pixels overwrite the destination.
+    BLENDMODE_NONE = 0,
+    // Pixels with alpha are composited over an RGB565 or PF_RGB565_BE destination.
+    BLENDMODE_BLEND
+};
+
+// Returns the number of bytes used in a given pixel format, rounded up to a whole byte for PF_INDEX4.
 uint8_t GetDepth(PixelFormat format);
 
+// Returns the number of bits used in a given pixel format.
+uint8_t GetBitsPerPixel(PixelFormat format);
+
+// Is the format made up of indices into a palette?
+bool IsIndexed(uint16_t format);
+
+// Converts count pixels from one format to another. The source and destination may be the same buffer if both formats have the same depth.
+// Returns false if either format is not supported; indexed formats need a palette, so are converted by BaseSurface::Blit() instead.
+bool ConvertPixels(uint16_t srcFormat, const void* src, uint16_t destFormat, void* dest, uint32_t count);
+
+class Surface;
+
 class BaseSurface
 {
 public:
@@ -40,21 +89,73 @@ public:
     // Returns the height in pixels.
     uint32_t GetHeight();
 
-    // Fills the entire surface with a given color.
+    // Set the filtering used when blitting this surface at a different size. Bilinear filtering only applies between RGB565 surfaces.
+    void SetScaleMode(ScaleMode mode);
+
+    // Returns the filtering used when blitting this surface at a different size.
+    ScaleMode GetScaleMode();
+
+    // Set how this surface is combined with the destination when blitted.
+    void SetBlendMode(BlendMode mode);
+
+    // Returns how this surface is combined with the destination when blitted.
+    BlendMode GetBlendMode();
+
+    // Returns the RGB565 palette of an indexed surface, or nullptr for other formats.
+    uint16_t* GetPalette();
+
+    // Returns the number of palette entries, 16 for PF_INDEX4 and 256 for PF_INDEX8, otherwise 0.
+    uint16_t GetPaletteSize();
+
+    // Copies RGB565 colors into the palette from a given entry onwards. Pixels are only looked up in the palette when
+    // an indexed surface is blitted or presented, so this recolors every pixel using those entries without touching them.
+    void SetPalette(const uint16_t* colors, uint16_t count, uint16_t first = 0);
+
+    // Expands count pixels of an indexed surface, starting at (x, y), to RGB565 through the palette.
+    void ExpandIndexed(int x, int y, uint32_t count, uint16_t* out);
+
+    // Fills the entire surface with a given color, specified as a raw pixel in the format of this surface.
+    // For PF_RGBA5658, the alpha goes in bits 16 to 23 above the RGB565 color. For indexed formats, it's a palette index.
+    // For PF_RGB565_BE, swap the color once with Swap565() rather than per pixel.
     void Clear(uint32_t color);
 
+    // Fills an area of the surface with a given color, clipped to the surface. The color is specified as in Clear().
+    void FillRect(IntRect rect, uint32_t color);
+
     // Copies the pixels of another surface of the same dimensions and format.
     void Replicate(BaseSurface* other);
 
-    // TODO: Makes a copy of this surface in the specified format.
-    //Surface* ConvertTo(uint16_t format);
+    // Copies an area of pixels from another surface of the same format into the same area of this surface.
+    void Replicate(BaseSurface* other, IntRect area);
+
+    // Same as Replicate(), but uses DMA when SURFACE_DMA_COPY is defined and returns before the copy completes.
+    // Neither surface should be touched until WaitReplicate() returns. Without DMA, copies immediately.
+    void ReplicateAsync(BaseSurface* other);
+
+    // Blocks until the copy started by ReplicateAsync() has completed.
+    static void WaitReplicate();
+
+    // Makes a copy of this surface in the specified format. Returns NULL on failure.
+    // The caller is responsible for calling Destroy() and deleting the returned surface.
+    Surface* ConvertTo(uint16_t format);
+
+    // Converts the pixels of this surface to another format with the same depth, without allocating.
+    // Returns false if the formats differ in depth.
+    bool ConvertInPlace(uint16_t format);
 
     // Draws this surface onto another surface at area specified by destRect. If srcRect is NULL, draws the entire surface, otherwise draws pixels from that area.
-    //void Blit(Surface* dest, IntRect* destRect = nullptr, IntRect* srcRect = nullptr);
+    // If destRect is NULL, draws at the top-left of the destination. Both areas are clipped to their respective surfaces.
+    // If destRect has different dimensions to the source area, the pixels are scaled to fit.
+    // Indexed surfaces are expanded through their palette, or copy their indices as they are to a surface of the same format.
+    // Nothing can be blitted to an indexed surface from any other format.
+    void Blit(BaseSurface* dest, IntRect* destRect = nullptr, IntRect* srcRect = nullptr);
 
 protected:
     // Internal method for handling scaling if the specified destRect in Blit() has differing dimensions.
-    void BlitScaled();
+    void BlitScaled(BaseSurface* dest, IntRect area, IntRect src);
+
+    // Internal method for Blit() from an indexed surface, once both areas are clipped.
+    void BlitIndexed(BaseSurface* dest, IntRect area, IntRect src);
 
     // Array of pixels
     void* pixels = nullptr;
@@ -65,6 +166,15 @@ protected:
     // The format of pixels in this surface
     uint16_t format = PF_RGB565;
 
+    // RGB565 colors that indexed pixels refer to
+    uint16_t* palette = nullptr;
+
+    // Filtering used by BlitScaled()
+    uint8_t scaleMode = SCALEMODE_NEAREST;
+
+    // Blending used by Blit()
+    uint8_t blendMode = BLENDMODE_NONE;
+
     // Width
     uint32_t w;
 
@@ -76,13 +186,23 @@ protected:
 class Surface : public BaseSurface
 {
 public:
-    // Takes a specified PixelFormat, width, height and color.
-    void Init(uint32_t w, uint32_t h, uint8_t format = PF_RGB565, bool usePSRAM = false);
+    // Takes a specified PixelFormat, width, height and where the pixels should be allocated, see SurfacePlacement.
+    void Init(uint32_t w, uint32_t h, uint8_t format = PF_RGB565, uint8_t placement = PLACEMENT_SRAM);
     void Init(void* pixels, uint8_t format = PF_RGB565);
 
-    // Destructor to free pixels
+    // Destructor to free pixels and the palette
     void Destroy();
 
+    // Exchanges pixels and properties with another surface, e.g. to flip between a pair of buffers.
+    void Swap(Surface* other);
+
+    // Returns where the pixels were actually allocated, which may differ from the requested placement.
+    uint8_t GetPlacement();
+
+private:
+    // Where the pixels were allocated.
+    uint8_t placement = PLACEMENT_SRAM;
+
 };
 
 /// Same as an ordinary surface, but instead of dynamically allocating memory, does so at compile time.
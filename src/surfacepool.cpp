@@ -0,0 +1,183 @@
+#include <vector>
+#include "surfacepool.h"
+
+// A freed block kept for reuse.
+struct PooledBlock
+{
+    void* memory;
+    uint32_t size;
+    uint8_t placement;
+};
+
+static std::vector<PooledBlock> pooledBlocks;
+
+static SurfacePoolStats stats = {};
+
+// Heap capabilities required by each placement.
+static const uint32_t placementCaps[PLACEMENT_COUNT] = {
+    MALLOC_CAP_DMA | MALLOC_CAP_8BIT,
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT
+};
+
+// Placements tried in order for each requested placement, terminated by PLACEMENT_COUNT.
+static const uint8_t fallbackChain[PLACEMENT_COUNT][PLACEMENT_COUNT] = {
+    { PLACEMENT_DMA, PLACEMENT_COUNT, PLACEMENT_COUNT },
+    { PLACEMENT_SRAM, PLACEMENT_PSRAM, PLACEMENT_COUNT },
+    { PLACEMENT_PSRAM, PLACEMENT_SRAM, PLACEMENT_COUNT }
+};
+
+// Returns the bytes of pooled blocks that are in internal memory, or in PSRAM.
+static uint32_t GetPooledBytes(bool psram)
+{
+    uint32_t bytes = 0;
+    for (unsigned int i = 0, counti = pooledBlocks.size(); i < counti; i++)
+    {
+        if ((pooledBlocks[i].placement == PLACEMENT_PSRAM) == psram)
+        {
+            bytes += pooledBlocks[i].size;
+        }
+    }
+    return bytes;
+}
+
+// Takes a pooled block of a given size class and placement, or returns nullptr if there isn't one.
+static void* TakePooled(uint32_t size, uint8_t placement)
+{
+    for (unsigned int i = 0, counti = pooledBlocks.size(); i < counti; i++)
+    {
+        if (pooledBlocks[i].size == size && pooledBlocks[i].placement == placement)
+        {
+            void* memory = pooledBlocks[i].memory;
+            pooledBlocks[i] = pooledBlocks.back();
+            pooledBlocks.pop_back();
+            stats.pooled -= size;
+            return memory;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t SurfacePool::GetSizeClass(uint32_t size)
+{
+    // Small blocks round up to a power of two, larger ones to a multiple of 4 KB so that full screen buffers waste little.
+    if (size <= 4096)
+    {
+        uint32_t sizeClass = 64;
+        while (sizeClass < size)
+        {
+            sizeClass <<= 1;
+        }
+        return sizeClass;
+    }
+    return (size + 4095) & ~4095UL;
+}
+
+void* SurfacePool::Allocate(uint32_t size, uint8_t placement, uint8_t* placed)
+{
+    if (placement >= PLACEMENT_COUNT)
+    {
+        placement = PLACEMENT_SRAM;
+    }
+    size = GetSizeClass(size);
+    stats.allocations++;
+
+    void* memory = nullptr;
+    for (int attempt = 0; attempt < 2 && memory == nullptr; attempt++)
+    {
+        for (int i = 0; i < PLACEMENT_COUNT && memory == nullptr; i++)
+        {
+            uint8_t candidate = fallbackChain[placement][i];
+            if (candidate == PLACEMENT_COUNT)
+            {
+                break;
+            }
+            if (candidate == PLACEMENT_PSRAM && !psramFound())
+            {
+                continue;
+            }
+
+            memory = TakePooled(size, candidate);
+            if (memory != nullptr)
+            {
+                stats.reused++;
+            }
+            else
+            {
+                memory = heap_caps_malloc(size, placementCaps[candidate]);
+            }
+            if (memory != nullptr)
+            {
+                *placed = candidate;
+            }
+        }
+        if (memory == nullptr)
+        {
+            // Pooled blocks of other sizes might be what's in the way, so give them back to the heap and try again.
+            Trim();
+        }
+    }
+
+    if (memory == nullptr)
+    {
+        stats.failures++;
+        return nullptr;
+    }
+    if (*placed != placement)
+    {
+        stats.fallbacks++;
+    }
+    stats.used[*placed] += size;
+    stats.peak[*placed] = max(stats.peak[*placed], stats.used[*placed]);
+    return memory;
+}
+
+void SurfacePool::Free(void* memory, uint32_t size, uint8_t placement)
+{
+    if (memory == nullptr || placement >= PLACEMENT_COUNT)
+    {
+        return;
+    }
+    size = GetSizeClass(size);
+    stats.used[placement] -= size;
+
+    bool psram = placement == PLACEMENT_PSRAM;
+    if (GetPooledBytes(psram) + size <= (psram ? SURFACEPOOL_RETAIN_PSRAM : SURFACEPOOL_RETAIN_INTERNAL))
+    {
+        pooledBlocks.push_back((PooledBlock){memory, size, placement});
+        stats.pooled += size;
+    }
+    else
+    {
+        free(memory);
+    }
+}
+
+void SurfacePool::Trim()
+{
+    for (unsigned int i = 0, counti = pooledBlocks.size(); i < counti; i++)
+    {
+        free(pooledBlocks[i].memory);
+    }
+    pooledBlocks.clear();
+    stats.pooled = 0;
+}
+
+SurfacePoolStats SurfacePool::GetStats()
+{
+    return stats;
+}
+
+float SurfacePool::GetFragmentation(uint8_t placement)
+{
+    if (placement >= PLACEMENT_COUNT)
+    {
+        return 0.0f;
+    }
+    uint32_t freeBytes = heap_caps_get_free_size(placementCaps[placement]);
+    if (freeBytes == 0)
+    {
+        return 0.0f;
+    }
+    return 1.0f - ((float)heap_caps_get_largest_free_block(placementCaps[placement]) / (float)freeBytes);
+}
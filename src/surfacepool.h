@@ -0,0 +1,74 @@
+#ifndef SURFACEPOOL_H
+#define SURFACEPOOL_H
+
+#include <Arduino.h>
+
+// How many bytes of freed internal memory (DMA and SRAM) and PSRAM blocks are kept for reuse.
+#define SURFACEPOOL_RETAIN_INTERNAL (128 * 1024)
+#define SURFACEPOOL_RETAIN_PSRAM (1024 * 1024)
+
+// Where the pixels of a surface are allocated.
+enum SurfacePlacement
+{
+    // Internal memory that SPI DMA can read, for buffers sent to the panel. Never falls back to PSRAM.
+    PLACEMENT_DMA = 0,
+    // Internal memory, for surfaces that are drawn to often. Falls back to PSRAM.
+    PLACEMENT_SRAM,
+    // External PSRAM, for large or rarely touched surfaces such as caches. Falls back to internal memory.
+    PLACEMENT_PSRAM,
+    PLACEMENT_COUNT
+};
+
+// Memory use of surface pixels.
+struct SurfacePoolStats
+{
+    // Bytes held by surfaces in each placement.
+    uint32_t used[PLACEMENT_COUNT];
+
+    // Highest bytes held by surfaces at once in each placement.
+    uint32_t peak[PLACEMENT_COUNT];
+
+    // Bytes of freed blocks kept for reuse.
+    uint32_t pooled;
+
+    // Number of allocations requested.
+    uint32_t allocations;
+
+    // Number of allocations that reused a pooled block.
+    uint32_t reused;
+
+    // Number of allocations that had to use a different placement than requested.
+    uint32_t fallbacks;
+
+    // Number of allocations that failed.
+    uint32_t failures;
+};
+
+/// Allocates surface pixels by placement policy, rounding sizes up into size classes and keeping freed blocks for reuse.
+/// Surfaces of the same size are regularly freed and created again as apps start and stop, so reusing their blocks
+/// keeps the heap from fragmenting around them.
+class SurfacePool
+{
+public:
+    // Allocates at least size bytes in the requested placement, or the next placement in its fallback chain.
+    // Outputs the placement actually used, which must be passed back to Free(). Returns nullptr on failure.
+    static void* Allocate(uint32_t size, uint8_t placement, uint8_t* placed);
+
+    // Returns a block to the pool. The size and placement must match those the block was allocated with.
+    static void Free(void* memory, uint32_t size, uint8_t placement);
+
+    // Frees all pooled blocks back to the heap.
+    static void Trim();
+
+    // Returns allocation statistics.
+    static SurfacePoolStats GetStats();
+
+    // Returns how fragmented the heap for a placement is, from 0 (all free memory is one block) to 1.
+    static float GetFragmentation(uint8_t placement);
+
+    // Returns the size class an allocation of a given size is rounded up to.
+    static uint32_t GetSizeClass(uint32_t size);
+
+};
+
+#endif // SURFACEPOOL_H
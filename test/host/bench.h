@@ -0,0 +1,36 @@
+// Timing helpers shared by the host benchmarks.
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <chrono>
+#include <stdint.h>
+
+// Calls a function in growing batches until a fifth of a second has passed, and returns the average seconds per call.
+template<typename Function>
+double TimePerCall(Function function)
+{
+    // Warm up the caches first.
+    function();
+
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    uint64_t calls = 0;
+    for (uint64_t batch = 1; elapsed < 0.2; batch *= 2)
+    {
+        for (uint64_t i = 0; i < batch; i++)
+        {
+            function();
+        }
+        calls += batch;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsed / calls;
+}
+
+// Returns millions of pixels per second for a call that covers the given number of pixels.
+inline double MegapixelsPerSecond(double seconds, uint32_t pixels)
+{
+    return pixels / seconds / 1e6;
+}
+
+#endif // HOST_BENCH_H
@@ -0,0 +1,29 @@
+// Measures how fast PackedImageDecoder decodes a 240x240 watch face packed by tools/packimage.py.
+#include <chrono>
+#include <stdio.h>
+#include "image.h"
+#include "dial.h"
+
+int main()
+{
+    const int iterations = 2000;
+    PackedImageDecoder decoder;
+    uint32_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        decoder.Begin(&Dial);
+        while (const uint16_t* row = decoder.NextRow())
+        {
+            checksum += row[Dial.w / 2];
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double pixels = (double)iterations * Dial.w * Dial.h;
+    printf("bench_packedimage: %.1f Mpixel/s, %.1f us per %ux%u image, %u bytes packed (checksum %08x)\n",
+        pixels / seconds / 1e6, seconds * 1e6 / iterations, Dial.w, Dial.h, Dial.size, checksum);
+    decoder.Destroy();
+    return 0;
+}
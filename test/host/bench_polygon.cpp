@@ -0,0 +1,43 @@
+// Measures Rasterizer::FillPolygon over a range of vertex counts, for convex polygons and concave stars of the same
+// size, filled into a 240x240 RGB565 surface.
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include "bench.h"
+#include "rasterizer.h"
+
+// Returns the vertices of a polygon centred on the screen. Stars alternate between the outer and an inner radius.
+static std::vector<Point> MakePolygon(int count, bool star)
+{
+    std::vector<Point> vertices;
+    for (int i = 0; i < count; i++)
+    {
+        float angle = (float)i * 2.0f * (float)M_PI / count;
+        float radius = star && (i & 1) ? 50.0f : 110.0f;
+        vertices.push_back(Point(120.0f + (radius * cosf(angle)), 120.0f + (radius * sinf(angle))));
+    }
+    return vertices;
+}
+
+int main()
+{
+    Surface surface;
+    surface.Init(240, 240, PF_RGB565);
+    Rasterizer rasterizer;
+    rasterizer.SetTarget(&surface);
+
+    printf("bench_polygon: microseconds per fill\n");
+    printf("%-10s %10s %10s\n", "vertices", "convex", "star");
+    const int counts[] = { 3, 4, 8, 16, 32, 64, 128, 256 };
+    for (int count : counts)
+    {
+        std::vector<Point> convex = MakePolygon(count, false);
+        std::vector<Point> star = MakePolygon(count, true);
+        double convexTime = TimePerCall([&] () { rasterizer.FillPolygon(convex.data(), count, 0xF81F); });
+        double starTime = TimePerCall([&] () { rasterizer.FillPolygon(star.data(), count, 0x07E0); });
+        printf("%-10d %10.2f %10.2f\n", count, convexTime * 1e6, starTime * 1e6);
+    }
+
+    surface.Destroy();
+    return 0;
+}
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Writes the binary PPM images that the host tests and benchmarks pack with tools/packimage.py.
+
+Usage:
+    images.py build/gen
+"""
+
+import math
+import os
+import sys
+
+
+def WritePPM(path, rows):
+    with open(path, "wb") as f:
+        f.write(b"P6\n%d %d\n255\n" % (len(rows[0]), len(rows)))
+        for row in rows:
+            for r, g, b in row:
+                f.write(bytes((r, g, b)))
+
+
+def Distinct(i):
+    """Returns a colour that differs from its neighbours in RGB565, so runs of them are packed as literals."""
+    return ((i * 37) & 0xF8, (i * 4) & 0xFC, (255 - i) & 0xF8)
+
+
+def RoundTrip():
+    """Rows that the packer encodes with each op, with both short and extended (64 or more) counts."""
+    width = 100
+    rows = []
+    # Short literal, short run, extended literal.
+    rows.append([Distinct(i) for i in range(10)] + [(0, 252, 0)] * 5 + [Distinct(i) for i in range(10, 95)])
+    # Extended run.
+    rows.append([(248, 0, 248)] * width)
+    # Extended copy up.
+    rows.append(list(rows[1]))
+    # Short copy up, then an extended run that the row above doesn't match.
+    rows.append(rows[2][:20] + [(0, 0, 248)] * (width - 20))
+    return rows
+
+
+def Dial():
+    """A 240x240 watch face: flat background, a shaded ring and tick marks, for decode benchmarks."""
+    size = 240
+    centre = (size - 1) / 2.0
+    rows = []
+    for y in range(size):
+        row = []
+        for x in range(size):
+            dx = x - centre
+            dy = y - centre
+            distance = math.hypot(dx, dy)
+            angle = math.atan2(dy, dx)
+            if distance > 118:
+                color = (0, 0, 0)
+            elif distance > 100:
+                shade = int(128 + (127 * math.sin(angle * 3)))
+                color = (shade, shade // 2, 255 - shade)
+            elif distance > 80 and (int(math.degrees(angle) + 360) % 30) < 2:
+                color = (255, 255, 255)
+            else:
+                color = (16, 24, 48)
+            row.append(color)
+        rows.append(row)
+    return rows
+
+
+def main():
+    output = sys.argv[1]
+    os.makedirs(output, exist_ok=True)
+    WritePPM(os.path.join(output, "roundtrip.ppm"), RoundTrip())
+    WritePPM(os.path.join(output, "dial.ppm"), Dial())
+
+
+if __name__ == "__main__":
+    main()
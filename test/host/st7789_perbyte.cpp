@@ -0,0 +1,5 @@
+// The display driver built without ESP32_BULK_MODE, so every byte goes out with its own SPI.transfer() as it did
+// before. test_st7789 compares it with the bulk path on the same mock bus.
+#undef ARDUINO_ARCH_ESP32
+#define Arduino_ST7789 Arduino_ST7789_PerByte
+#include "Arduino_ST7789_Fast.cpp"
@@ -0,0 +1,20 @@
+// Host stand-in for the Adafruit GFX base class of Arduino_ST7789.
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include <stdint.h>
+
+class Adafruit_GFX
+{
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+    virtual ~Adafruit_GFX() {}
+
+protected:
+    int16_t _width;
+    int16_t _height;
+    uint8_t rotation = 0;
+
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
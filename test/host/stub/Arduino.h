@@ -0,0 +1,98 @@
+// Host stand-in for the Arduino core, covering only what the OS sources use.
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// On the watch, src is on the include path, so the core's <time.h> finds the OS's own time.h and headers such as
+// display.h rely on it for Timer. Here src is only searched for quoted includes, so system headers keep their own.
+#include "time.h"
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+
+#define IRAM_ATTR
+#define PROGMEM
+#define pgm_read_byte(a) (*(const uint8_t*)(a))
+#define pgm_read_word(a) (*(const uint16_t*)(a))
+
+// Memory capabilities. Allocations with any of the capabilities in FailCaps() fail, to test fallbacks.
+#define MALLOC_CAP_DMA 1
+#define MALLOC_CAP_8BIT 2
+#define MALLOC_CAP_SPIRAM 4
+#define MALLOC_CAP_INTERNAL 8
+
+inline uint32_t& FailCaps()
+{
+    static uint32_t caps = 0;
+    return caps;
+}
+
+inline void* heap_caps_malloc(size_t size, uint32_t caps) { return (caps & FailCaps()) ? nullptr : malloc(size); }
+inline size_t heap_caps_get_free_size(uint32_t) { return 100000; }
+inline size_t heap_caps_get_largest_free_block(uint32_t) { return 100000; }
+inline void* ps_malloc(size_t size) { return malloc(size); }
+inline bool psramFound() { return true; }
+
+// Time stands still on the host, so tests control when apps are due by invalidating them.
+inline uint32_t millis() { return 0; }
+inline uint32_t micros() { return 0; }
+inline void delay(uint32_t) {}
+
+inline void setCpuFrequencyMhz(int) {}
+inline uint32_t getCpuFrequencyMhz() { return 160; }
+
+struct HardwareSerial
+{
+    void begin(int) {}
+    template<typename... Args> void printf(const char* format, Args... args) { ::printf(format, args...); }
+};
+extern HardwareSerial Serial;
+
+// The cycle counter advances by a fixed step per read.
+struct EspClass
+{
+    uint32_t cycles = 0;
+    uint32_t step = 1600;
+    uint32_t getCycleCount() { return cycles += step; }
+};
+extern EspClass ESP;
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_BLUE 0x001F
+#define TFT_YELLOW 0xFFE0
+#define TFT_ORANGE 0xFDA0
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+#endif // HOST_ARDUINO_H
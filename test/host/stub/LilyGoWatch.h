@@ -0,0 +1,307 @@
+// Host stand-in for the T-Watch library and the parts of FreeRTOS and ESP-IDF the OS uses. The panel is simulated by
+// TFT_eSPI::vram, which holds the colors pushed to it in native byte order.
+#ifndef HOST_LILYGOWATCH_H
+#define HOST_LILYGOWATCH_H
+
+#include "Arduino.h"
+#include <functional>
+
+//
+// FreeRTOS
+//
+
+typedef void* QueueHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFF
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) (ms)
+#define portYIELD_FROM_ISR()
+
+inline int uxQueueMessagesWaiting(QueueHandle_t) { return 0; }
+inline int xQueueReceive(QueueHandle_t, void*, uint32_t) { return 0; }
+inline int xQueuePeek(QueueHandle_t, void*, uint32_t) { return 0; }
+inline int xQueueSend(QueueHandle_t, const void*, uint32_t) { return 0; }
+inline void vTaskDelay(uint32_t) {}
+inline uint32_t xTaskGetTickCount() { return 0; }
+inline uint32_t ulTaskNotifyTake(BaseType_t, uint32_t) { return 0; }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return (TaskHandle_t)1; }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t* woken) { *woken = pdTRUE; }
+
+//
+// Display
+//
+
+inline uint16_t HostSwapBytes(uint16_t c) { return (uint16_t)((c >> 8) | (c << 8)); }
+
+class TFT_eSPI
+{
+public:
+    int16_t width() { return 240; }
+    int16_t height() { return 240; }
+
+    // Shapes aren't simulated, only pushed pixels are.
+    void fillScreen(uint16_t) {}
+    void fillRect(int32_t, int32_t, int32_t, int32_t, uint16_t) {}
+    void drawPixel(int32_t, int32_t, uint16_t) {}
+    void drawLine(int32_t, int32_t, int32_t, int32_t, uint16_t) {}
+    void drawFastHLine(int32_t, int32_t, int32_t, uint16_t) {}
+    void drawFastVLine(int32_t, int32_t, int32_t, uint16_t) {}
+    void drawCircle(int32_t, int32_t, int32_t, uint16_t) {}
+    void fillCircle(int32_t, int32_t, int32_t, uint16_t) {}
+    void drawRoundRect(int32_t, int32_t, int32_t, int32_t, int32_t, uint16_t) {}
+    void fillRoundRect(int32_t, int32_t, int32_t, int32_t, int32_t, uint16_t) {}
+    void fillEllipse(int32_t, int32_t, int32_t, int32_t, uint16_t) {}
+    void drawTriangle(int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, uint16_t) {}
+    void fillTriangle(int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, uint16_t) {}
+
+    void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+        windowX = x;
+        windowY = y;
+        windowW = max(w, (int32_t)1);
+        windowPos = 0;
+        windows++;
+    }
+
+    void pushPixels(const void* data, uint32_t count) { Put((const uint16_t*)data, count); }
+
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data)
+    {
+        setAddrWindow(x, y, w, h);
+        Put(data, w * h);
+    }
+
+    void pushRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) { pushImage(x, y, w, h, data); }
+
+    // Like TFT_eSPI, swaps the pixels in place before sending them when swapping bytes.
+    void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t* buffer = nullptr)
+    {
+        setAddrWindow(x, y, w, h);
+        if (swapBytes)
+        {
+            for (int32_t i = 0; i < w * h; i++)
+            {
+                data[i] = HostSwapBytes(data[i]);
+            }
+        }
+        for (int32_t i = 0; i < w * h; i++)
+        {
+            PutPixel(HostSwapBytes(data[i]));
+        }
+        dmaPushes++;
+    }
+
+    void pushColor(uint16_t, uint32_t) {}
+    bool initDMA() { return true; }
+    void deInitDMA() {}
+    void dmaWait() {}
+    bool dmaBusy() { return false; }
+    void startWrite() {}
+    void endWrite() {}
+    void setSwapBytes(bool swap) { swapBytes = swap; }
+    bool getSwapBytes() { return swapBytes; }
+    void writecommand(uint8_t) {}
+    void writedata(uint8_t) {}
+
+    void setTextWrap(bool) {}
+    void setTextDatum(uint8_t) {}
+    void setTextFont(uint8_t) {}
+    void setTextSize(uint8_t) {}
+    void setTextColor(uint16_t) {}
+    void setTextColor(uint16_t, uint16_t) {}
+    void setCursor(int16_t, int16_t) {}
+    int16_t textWidth(const char*, uint8_t = 0) { return 10; }
+    int16_t fontHeight(int16_t = 0) { return 10; }
+    int16_t drawString(const char*, int32_t, int32_t, uint8_t = 0) { return 0; }
+    int16_t drawChar(uint16_t, int32_t, int32_t, uint8_t) { return 0; }
+    template<typename... Args> void printf(const char*, Args...) {}
+
+    uint8_t textfont = 1;
+    uint8_t textsize = 1;
+
+    // Panel memory, 240x320 like the ST7789, in native byte order.
+    uint16_t vram[240 * 320] = { 0 };
+
+    // Number of address windows set and DMA transfers started.
+    int windows = 0;
+    int dmaPushes = 0;
+
+private:
+    // Writes pixels as sent on the bus: swapped to high byte first when swapping bytes, as they are otherwise.
+    void Put(const uint16_t* data, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            PutPixel(swapBytes ? data[i] : HostSwapBytes(data[i]));
+        }
+    }
+
+    void PutPixel(uint16_t color)
+    {
+        int x = windowX + (windowPos % windowW);
+        int y = windowY + (windowPos / windowW);
+        // Pixels outside panel memory are dropped, as TFT_eSPI clips images to the screen.
+        if (x >= 0 && x < 240 && y >= 0 && y < 320)
+        {
+            vram[(y * 240) + x] = color;
+        }
+        windowPos++;
+    }
+
+    bool swapBytes = false;
+    int windowX = 0;
+    int windowY = 0;
+    int windowW = 1;
+    int windowPos = 0;
+
+};
+
+class TFT_eSprite : public TFT_eSPI
+{
+public:
+    TFT_eSprite(TFT_eSPI*) {}
+    void setColorDepth(int8_t) {}
+
+    void* createSprite(int16_t w, int16_t h)
+    {
+        spriteW = w;
+        spriteH = h;
+        buffer = (uint16_t*)calloc(w * h, sizeof(uint16_t));
+        return buffer;
+    }
+
+    void deleteSprite()
+    {
+        free(buffer);
+        buffer = nullptr;
+    }
+
+    // Sprites hold pixels high byte first.
+    void fillSprite(uint16_t color)
+    {
+        for (int i = 0; i < spriteW * spriteH; i++)
+        {
+            buffer[i] = HostSwapBytes(color);
+        }
+    }
+
+    void* getPointer() { return buffer; }
+
+private:
+    uint16_t* buffer = nullptr;
+    int spriteW = 0;
+    int spriteH = 0;
+
+};
+
+//
+// Peripherals
+//
+
+class AXP20X_Class
+{
+public:
+    void setPowerOutPut(uint8_t, bool) {}
+    bool isChargeing() { return false; }
+    int getBattPercentage() { return 50; }
+    float getTemp() { return 0; }
+    void adc1Enable(uint16_t, bool) {}
+    void adc2Enable(uint16_t, bool) {}
+};
+
+struct RTC_Date
+{
+    uint8_t second;
+    uint8_t minute;
+    uint8_t hour;
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+};
+
+class PCF8563_Class
+{
+public:
+    RTC_Date getDateTime() { return RTC_Date(); }
+    uint8_t getDayOfWeek(uint8_t, uint8_t, uint16_t) { return 1; }
+};
+
+struct Acfg
+{
+    int odr;
+    int range;
+    int bandwidth;
+    int perf_mode;
+};
+
+class BMA
+{
+public:
+    void accelConfig(Acfg) {}
+    void enableFeature(uint8_t, bool) {}
+    void resetStepCounter() {}
+};
+
+class TTGOClass
+{
+public:
+    static TTGOClass* getWatch();
+    void begin() {}
+    void motor_begin() {}
+    void openBL() {}
+    void displayWakeup() {}
+    void displaySleep() {}
+    void setBrightness(uint8_t) {}
+    void shake() {}
+
+    TFT_eSPI* tft = nullptr;
+    AXP20X_Class* power = nullptr;
+    PCF8563_Class* rtc = nullptr;
+    BMA* bma = nullptr;
+};
+
+#define AXP202_LDO2 2
+#define AXP202_BATT_VOL_ADC1 3
+#define AXP202_BATT_CUR_ADC1 4
+#define AXP202_VBUS_VOL_ADC1 5
+#define AXP202_VBUS_CUR_ADC1 6
+#define AXP202_ON 7
+#define AXP202_OFF 8
+#define AXP202_EXTEN 9
+#define AXP202_DCDC2 10
+#define AXP202_LDO3 11
+#define AXP202_LDO4 12
+#define AXP202_TS_PIN_ADC1 13
+#define AXP202_TEMP_MONITORING_ADC2 14
+#define BMA4_OUTPUT_DATA_RATE_100HZ 15
+#define BMA4_ACCEL_RANGE_2G 16
+#define BMA4_ACCEL_NORMAL_AVG4 17
+#define BMA4_CONTINUOUS_MODE 18
+#define BMA423_STEP_CNTR 19
+#define BMA423_TILT 20
+#define BMA423_WAKEUP 21
+#define AXP202_INT 22
+
+//
+// Sleep
+//
+
+typedef int gpio_num_t;
+#define GPIO_INTR_LOW_LEVEL 23
+#define GPIO_SEL_39 24
+#define ESP_EXT1_WAKEUP_ANY_HIGH 25
+enum { ESP_SLEEP_WAKEUP_TIMER = 4 };
+
+inline void gpio_wakeup_enable(gpio_num_t, int) {}
+inline void esp_sleep_enable_gpio_wakeup() {}
+inline void esp_sleep_enable_ext1_wakeup(uint64_t, int) {}
+inline void esp_sleep_enable_timer_wakeup(uint64_t) {}
+inline void esp_sleep_disable_wakeup_source(int) {}
+inline void esp_light_sleep_start() {}
+
+#endif // HOST_LILYGOWATCH_H
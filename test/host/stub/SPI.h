@@ -0,0 +1,86 @@
+// Mock SPI bus that records every byte sent, and counts transactions and calls, so drivers can be checked on the host.
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stdint.h>
+#include <vector>
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+#define SPI_MODE3 3
+
+struct SPISettings
+{
+    SPISettings() {}
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass
+{
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void beginTransaction(SPISettings) { transactions++; }
+    void endTransaction() {}
+
+    uint8_t transfer(uint8_t data)
+    {
+        bytes.push_back(data);
+        calls++;
+        return 0;
+    }
+
+    void write(uint8_t data)
+    {
+        bytes.push_back(data);
+        calls++;
+    }
+
+    void writeBytes(const uint8_t* data, uint32_t size)
+    {
+        bytes.insert(bytes.end(), data, data + size);
+        calls++;
+    }
+
+    // Sends 16-bit pixels high byte first, size in bytes.
+    void writePixels(const void* data, uint32_t size)
+    {
+        const uint8_t* pixels = (const uint8_t*)data;
+        for (uint32_t i = 0; i + 1 < size; i += 2)
+        {
+            bytes.push_back(pixels[i + 1]);
+            bytes.push_back(pixels[i]);
+        }
+        calls++;
+    }
+
+    void writePattern(const uint8_t* data, uint8_t size, uint32_t repeat)
+    {
+        while (repeat--)
+        {
+            bytes.insert(bytes.end(), data, data + size);
+        }
+        calls++;
+    }
+
+    // Forgets everything sent so far.
+    void Reset()
+    {
+        bytes.clear();
+        transactions = 0;
+        calls = 0;
+    }
+
+    // Every byte sent, in order.
+    std::vector<uint8_t> bytes;
+
+    // Number of beginTransaction() calls.
+    uint32_t transactions = 0;
+
+    // Number of calls that sent data.
+    uint32_t calls = 0;
+
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
@@ -0,0 +1,20 @@
+#include <LilyGoWatch.h>
+#include <SPI.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+
+TTGOClass* TTGOClass::getWatch()
+{
+    static TFT_eSPI tft;
+    static AXP20X_Class power;
+    static PCF8563_Class rtc;
+    static BMA bma;
+    static TTGOClass watch;
+    watch.tft = &tft;
+    watch.power = &power;
+    watch.rtc = &rtc;
+    watch.bma = &bma;
+    return &watch;
+}
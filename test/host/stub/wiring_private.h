@@ -0,0 +1,2 @@
+// Empty host stand-in for an Arduino core header that the display driver includes.
+#pragma once
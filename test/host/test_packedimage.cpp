@@ -0,0 +1,119 @@
+// Packs images with tools/packimage.py and checks that PackedImageDecoder gives back the same pixels, and that it
+// stops at corrupt data instead of reading past it.
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "image.h"
+#include "roundtrip.h"
+
+// Reads a binary PPM written by images.py as RGB565, converted the same way as packimage.py.
+static std::vector<uint16_t> LoadPPM(const char* path, int* w, int* h)
+{
+    FILE* file = fopen(path, "rb");
+    assert(file != nullptr);
+    int maxval = 0;
+    assert(fscanf(file, "P6 %d %d %d", w, h, &maxval) == 3 && maxval == 255);
+    fgetc(file);
+    std::vector<uint16_t> pixels(*w * *h);
+    for (uint16_t& pixel : pixels)
+    {
+        uint8_t rgb[3];
+        assert(fread(rgb, 1, 3, file) == 3);
+        pixel = ((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3);
+    }
+    fclose(file);
+    return pixels;
+}
+
+// Decodes an image in full, returning the number of rows decoded before NextRow() returned nullptr.
+static int Decode(PackedImageDecoder& decoder, const PackedImage* image, std::vector<uint16_t>* pixels = nullptr)
+{
+    decoder.Begin(image);
+    int rows = 0;
+    while (const uint16_t* row = decoder.NextRow())
+    {
+        if (pixels != nullptr)
+        {
+            pixels->insert(pixels->end(), row, row + image->w);
+        }
+        rows++;
+    }
+    return rows;
+}
+
+// Decodes an image whose data is copied into a buffer of exactly its size, so reading past it trips the sanitizer.
+static int DecodeExact(PackedImageDecoder& decoder, const uint8_t* data, uint32_t size, uint16_t w, uint16_t h)
+{
+    std::vector<uint8_t> copy(data, data + size);
+    PackedImage image = { copy.data(), size, w, h };
+    return Decode(decoder, &image);
+}
+
+static void TestRoundTrip(PackedImageDecoder& decoder)
+{
+    int w = 0;
+    int h = 0;
+    std::vector<uint16_t> expected = LoadPPM(HOST_GEN_DIR "/roundtrip.ppm", &w, &h);
+    assert(RoundTrip.w == w && RoundTrip.h == h);
+
+    // The fixture should make the packer use every op, with both short and extended counts.
+    bool used[3][2] = { { false } };
+    uint32_t offset = 0;
+    while (offset < RoundTrip.size)
+    {
+        uint8_t op = RoundTrip.data[offset++];
+        bool extended = (op & 0x3F) == 0x3F;
+        uint32_t count = extended ? 64 + RoundTrip.data[offset++] : (op & 0x3F) + 1;
+        used[op >> 6][extended] = true;
+        offset += (op >> 6) == PACKEDOP_LITERAL ? count * 2 : (op >> 6) == PACKEDOP_RUN ? 2 : 0;
+    }
+    assert(offset == RoundTrip.size);
+    for (int op = PACKEDOP_LITERAL; op <= PACKEDOP_COPY_UP; op++)
+    {
+        assert(used[op][false] && used[op][true]);
+    }
+
+    std::vector<uint16_t> decoded;
+    assert(Decode(decoder, &RoundTrip, &decoded) == h);
+    assert(decoded == expected);
+    assert(decoder.NextRow() == nullptr);
+
+    // Decoding again starts from the top.
+    decoded.clear();
+    assert(Decode(decoder, &RoundTrip, &decoded) == h && decoded == expected);
+}
+
+static void TestCorrupt(PackedImageDecoder& decoder)
+{
+    // Every truncation of the stream stops before the last row.
+    for (uint32_t size = 0; size < RoundTrip.size; size++)
+    {
+        assert(DecodeExact(decoder, RoundTrip.data, size, RoundTrip.w, RoundTrip.h) < RoundTrip.h);
+    }
+
+    // Copying from the row above on the first row.
+    const uint8_t copyUp[] = { (PACKEDOP_COPY_UP << 6) | 3 };
+    assert(DecodeExact(decoder, copyUp, sizeof(copyUp), 4, 1) == 0);
+
+    // A run crossing the end of the row.
+    const uint8_t overrun[] = { (PACKEDOP_RUN << 6) | 4, 0x1F, 0x00 };
+    assert(DecodeExact(decoder, overrun, sizeof(overrun), 4, 1) == 0);
+
+    // An extended count missing its count byte, and a reserved op.
+    const uint8_t extended[] = { (PACKEDOP_LITERAL << 6) | 0x3F };
+    assert(DecodeExact(decoder, extended, sizeof(extended), 100, 1) == 0);
+    const uint8_t reserved[] = { 0xC0, 0x00, 0x00 };
+    assert(DecodeExact(decoder, reserved, sizeof(reserved), 1, 1) == 0);
+}
+
+int main()
+{
+    PackedImageDecoder decoder;
+    TestRoundTrip(decoder);
+    TestCorrupt(decoder);
+    decoder.Destroy();
+
+    puts("test_packedimage passed");
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Checks that the ESP32 bulk path of Arduino_ST7789_Fast sends exactly the bytes of the per-byte path it replaced,
+// in the same transactions but far fewer calls, for full window fills and images.
+#include <assert.h>
+#include <stdio.h>
+#include <SPI.h>
+#include "Arduino_ST7789_Fast.h"
+
+// The same driver built without ESP32_BULK_MODE by st7789_perbyte.cpp.
+#undef _ST7789_FAST_H_
+#define Arduino_ST7789 Arduino_ST7789_PerByte
+#include "Arduino_ST7789_Fast.h"
+#undef Arduino_ST7789
+
+// What a draw sent over the mock bus, and what the driver counted with ST7789_SPI_STATS.
+struct BusTraffic
+{
+    std::vector<uint8_t> bytes;
+    uint32_t transactions;
+    uint32_t calls;
+    uint32_t bytesCounted;
+    uint32_t transactionsCounted;
+};
+
+template<typename Driver, typename Draw>
+static BusTraffic Measure(Driver& driver, Draw draw)
+{
+    SPI.Reset();
+    driver.resetStats();
+    draw(driver);
+    return { SPI.bytes, SPI.transactions, SPI.calls, driver.getBytesSent(), driver.getTransactions() };
+}
+
+static void Compare(const char* name, const BusTraffic& bulk, const BusTraffic& perByte)
+{
+    printf("%-16s bulk: %u bytes, %u transactions, %u calls; per byte: %u bytes, %u transactions, %u calls\n", name,
+        (unsigned)bulk.bytes.size(), bulk.transactions, bulk.calls,
+        (unsigned)perByte.bytes.size(), perByte.transactions, perByte.calls);
+
+    assert(bulk.bytes == perByte.bytes);
+    assert(bulk.transactions == perByte.transactions);
+    assert(bulk.bytesCounted == bulk.bytes.size() && perByte.bytesCounted == perByte.bytes.size());
+    assert(bulk.transactionsCounted == bulk.transactions && perByte.transactionsCounted == perByte.transactions);
+    // Commands still go a byte at a time, but the window itself is a single call.
+    assert(bulk.calls < 20);
+    assert(perByte.calls == perByte.bytes.size());
+}
+
+int main()
+{
+    Arduino_ST7789 bulk(27, -1, 5);
+    Arduino_ST7789_PerByte perByte(27, -1, 5);
+    bulk.init();
+    perByte.init();
+
+    static uint16_t image[ST7789_TFTWIDTH * ST7789_TFTHEIGHT];
+    for (int i = 0; i < ST7789_TFTWIDTH * ST7789_TFTHEIGHT; i++)
+    {
+        image[i] = (uint16_t)((i * 2654435761u) >> 16);
+    }
+    const uint32_t windowBytes = ST7789_TFTWIDTH * ST7789_TFTHEIGHT * 2;
+
+    auto fill = [] (auto& driver) { driver.fillRect(0, 0, ST7789_TFTWIDTH, ST7789_TFTHEIGHT, 0xF81F); };
+    BusTraffic bulkFill = Measure(bulk, fill);
+    Compare("fillRect", bulkFill, Measure(perByte, fill));
+    // Pixels go high byte first.
+    assert(bulkFill.bytes.size() > windowBytes);
+    assert(bulkFill.bytes[bulkFill.bytes.size() - 2] == 0xF8 && bulkFill.bytes.back() == 0x1F);
+
+    auto draw = [] (auto& driver) { driver.drawImage(0, 0, ST7789_TFTWIDTH, ST7789_TFTHEIGHT, image); };
+    BusTraffic bulkImage = Measure(bulk, draw);
+    Compare("drawImage", bulkImage, Measure(perByte, draw));
+    uint16_t last = image[(ST7789_TFTWIDTH * ST7789_TFTHEIGHT) - 1];
+    assert(bulkImage.bytes[bulkImage.bytes.size() - 2] == (last >> 8) && bulkImage.bytes.back() == (last & 0xFF));
+
+    // Raw images are already high byte first, so go out as they are in memory.
+    auto raw = [] (auto& driver) { driver.drawImageRaw(0, 0, ST7789_TFTWIDTH, ST7789_TFTHEIGHT, image); };
+    BusTraffic bulkRaw = Measure(bulk, raw);
+    Compare("drawImageRaw", bulkRaw, Measure(perByte, raw));
+    assert(memcmp(&bulkRaw.bytes[bulkRaw.bytes.size() - windowBytes], image, windowBytes) == 0);
+
+    puts("test_st7789 passed");
+    return 0;
+}
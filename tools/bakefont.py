@@ -0,0 +1,533 @@
+#!/usr/bin/env python3
+"""Bakes a TrueType (.ttf) or BDF (.bdf) font into a C++ header of constexpr tables for FancyWatchOS.
+
+Glyph bitmaps are cropped to their bounds and packed at 1, 2 or 4 bits per pixel, most significant bits first, with each
+row starting on a byte boundary. Kerning pairs are read from the TrueType 'kern' table (GPOS kerning is not supported).
+Only TrueType outlines are supported, not CFF/OpenType outlines. No third party modules are required.
+
+Usage:
+    bakefont.py font.ttf --size 24 --bpp 4 --name Lato24 --output src/fonts/lato24.h
+    bakefont.py font.bdf --bpp 1 --name Terminus16 --first 32 --last 126
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+
+# Number of sub-scanlines sampled per pixel when rasterizing outlines.
+SUBSAMPLES = 8
+
+
+class Glyph:
+    def __init__(self, codepoint, advance, left, top, width, height, coverage):
+        self.codepoint = codepoint
+        # Horizontal distance to the next pen position, in pixels.
+        self.advance = advance
+        # Offset of the bitmap from the pen position, where top is measured down from the top of the line.
+        self.left = left
+        self.top = top
+        self.width = width
+        self.height = height
+        # Row major coverage values between 0 and 1.
+        self.coverage = coverage
+
+
+class Font:
+    def __init__(self):
+        self.glyphs = {}
+        # Line height and distance from the top of the line to the baseline, in pixels.
+        self.height = 0
+        self.baseline = 0
+        # Maps (left, right) codepoints to an advance adjustment in pixels.
+        self.kerning = {}
+
+
+#
+# TrueType
+#
+
+class TrueType:
+    def __init__(self, data):
+        self.data = data
+        numTables = struct.unpack_from(">H", data, 4)[0]
+        self.tables = {}
+        for i in range(numTables):
+            tag, checksum, offset, length = struct.unpack_from(">4sIII", data, 12 + (i * 16))
+            self.tables[tag.decode("latin-1")] = (offset, length)
+        if "glyf" not in self.tables:
+            raise ValueError("only fonts with TrueType outlines are supported")
+
+        head = self.tables["head"][0]
+        self.unitsPerEm = struct.unpack_from(">H", data, head + 18)[0]
+        self.longLoca = struct.unpack_from(">h", data, head + 50)[0] == 1
+        self.numGlyphs = struct.unpack_from(">H", data, self.tables["maxp"][0] + 4)[0]
+
+        hhea = self.tables["hhea"][0]
+        self.ascent, self.descent, self.lineGap = struct.unpack_from(">hhh", data, hhea + 4)
+        self.numHMetrics = struct.unpack_from(">H", data, hhea + 34)[0]
+
+        self.cmap = self.ReadCmap()
+
+    def U16(self, offset):
+        return struct.unpack_from(">H", self.data, offset)[0]
+
+    def ReadCmap(self):
+        base = self.tables["cmap"][0]
+        count = self.U16(base + 2)
+        best = None
+        for i in range(count):
+            platform, encoding, offset = struct.unpack_from(">HHI", self.data, base + 4 + (i * 8))
+            fmt = self.U16(base + offset)
+            if (platform == 3 and encoding in (1, 10)) or platform == 0:
+                if fmt == 12 or (fmt == 4 and best is None):
+                    best = (fmt, base + offset)
+        if best is None:
+            raise ValueError("no unicode cmap subtable")
+
+        cmap = {}
+        fmt, table = best
+        if fmt == 4:
+            segments = self.U16(table + 6) // 2
+            ends = table + 14
+            starts = ends + (segments * 2) + 2
+            deltas = starts + (segments * 2)
+            ranges = deltas + (segments * 2)
+            for i in range(segments):
+                end = self.U16(ends + (i * 2))
+                start = self.U16(starts + (i * 2))
+                delta = self.U16(deltas + (i * 2))
+                rangeOffset = self.U16(ranges + (i * 2))
+                for c in range(start, end + 1):
+                    if c == 0xFFFF:
+                        break
+                    if rangeOffset == 0:
+                        index = (c + delta) & 0xFFFF
+                    else:
+                        index = self.U16(ranges + (i * 2) + rangeOffset + ((c - start) * 2))
+                        if index != 0:
+                            index = (index + delta) & 0xFFFF
+                    cmap[c] = index
+        elif fmt == 12:
+            groups = struct.unpack_from(">I", self.data, table + 12)[0]
+            for i in range(groups):
+                start, end, index = struct.unpack_from(">III", self.data, table + 16 + (i * 12))
+                for c in range(start, end + 1):
+                    cmap[c] = index + (c - start)
+        return cmap
+
+    def GetAdvance(self, index):
+        hmtx = self.tables["hmtx"][0]
+        return self.U16(hmtx + (min(index, self.numHMetrics - 1) * 4))
+
+    def GetGlyphOffset(self, index):
+        loca = self.tables["loca"][0]
+        if self.longLoca:
+            start, end = struct.unpack_from(">II", self.data, loca + (index * 4))
+        else:
+            start, end = struct.unpack_from(">HH", self.data, loca + (index * 2))
+            start *= 2
+            end *= 2
+        return self.tables["glyf"][0] + start, end - start
+
+    def GetContours(self, index, depth=0):
+        """Returns the outline of a glyph as a list of contours, each a list of (x, y, onCurve) points in font units."""
+        offset, length = self.GetGlyphOffset(index)
+        if length == 0 or depth > 8:
+            return []
+        numContours = struct.unpack_from(">h", self.data, offset)[0]
+        if numContours >= 0:
+            return self.ReadSimpleGlyph(offset, numContours)
+
+        # Composite glyph, made up of transformed components.
+        contours = []
+        pos = offset + 10
+        while True:
+            flags, component = struct.unpack_from(">HH", self.data, pos)
+            pos += 4
+            if flags & 0x0001:
+                dx, dy = struct.unpack_from(">hh", self.data, pos)
+                pos += 4
+            else:
+                dx, dy = struct.unpack_from(">bb", self.data, pos)
+                pos += 2
+            xx, xy, yx, yy = 1.0, 0.0, 0.0, 1.0
+            if flags & 0x0008:
+                xx = yy = struct.unpack_from(">h", self.data, pos)[0] / 16384.0
+                pos += 2
+            elif flags & 0x0040:
+                xx, yy = [v / 16384.0 for v in struct.unpack_from(">hh", self.data, pos)]
+                pos += 4
+            elif flags & 0x0080:
+                xx, xy, yx, yy = [v / 16384.0 for v in struct.unpack_from(">hhhh", self.data, pos)]
+                pos += 8
+            if not flags & 0x0002:
+                # Point matching isn't supported, treat as no offset.
+                dx = dy = 0
+            for contour in self.GetContours(component, depth + 1):
+                contours.append([((x * xx) + (y * yx) + dx, (x * xy) + (y * yy) + dy, on) for x, y, on in contour])
+            if not flags & 0x0020:
+                break
+        return contours
+
+    def ReadSimpleGlyph(self, offset, numContours):
+        ends = struct.unpack_from(">%dH" % numContours, self.data, offset + 10)
+        numPoints = ends[-1] + 1 if numContours > 0 else 0
+        pos = offset + 10 + (numContours * 2)
+        pos += 2 + self.U16(pos)
+
+        flags = []
+        while len(flags) < numPoints:
+            flag = self.data[pos]
+            pos += 1
+            flags.append(flag)
+            if flag & 0x08:
+                repeat = self.data[pos]
+                pos += 1
+                flags.extend([flag] * repeat)
+
+        def ReadCoordinates(shortBit, sameBit):
+            nonlocal pos
+            values = []
+            value = 0
+            for flag in flags:
+                if flag & shortBit:
+                    delta = self.data[pos]
+                    pos += 1
+                    value += delta if flag & sameBit else -delta
+                elif not flag & sameBit:
+                    value += struct.unpack_from(">h", self.data, pos)[0]
+                    pos += 2
+                values.append(value)
+            return values
+
+        xs = ReadCoordinates(0x02, 0x10)
+        ys = ReadCoordinates(0x04, 0x20)
+
+        contours = []
+        start = 0
+        for end in ends:
+            contours.append([(xs[i], ys[i], bool(flags[i] & 0x01)) for i in range(start, end + 1)])
+            start = end + 1
+        return contours
+
+    def GetKerning(self):
+        """Returns a map of (left glyph index, right glyph index) to adjustment in font units."""
+        pairs = {}
+        if "kern" not in self.tables:
+            return pairs
+        base = self.tables["kern"][0]
+        version, numTables = struct.unpack_from(">HH", self.data, base)
+        if version != 0:
+            return pairs
+        pos = base + 4
+        for i in range(numTables):
+            length, coverage = struct.unpack_from(">HH", self.data, pos + 2)
+            if coverage >> 8 == 0 and coverage & 0x01:
+                numPairs = self.U16(pos + 6)
+                for j in range(numPairs):
+                    left, right, value = struct.unpack_from(">HHh", self.data, pos + 14 + (j * 6))
+                    pairs[(left, right)] = value
+            pos += length
+        return pairs
+
+
+def FlattenContour(contour, scale):
+    """Converts a contour of quadratic curves into a closed polygon in pixels, with y pointing down."""
+    # Insert the implied on-curve points between consecutive off-curve points.
+    points = []
+    count = len(contour)
+    for i in range(count):
+        x, y, on = contour[i]
+        nx, ny, non = contour[(i + 1) % count]
+        points.append((x, y, on))
+        if not on and not non:
+            points.append(((x + nx) / 2.0, (y + ny) / 2.0, True))
+
+    # Start from an on-curve point.
+    start = next(i for i, p in enumerate(points) if p[2])
+    points = points[start:] + points[:start]
+
+    polygon = []
+    i = 0
+    count = len(points)
+    while i < count:
+        x0, y0, on0 = points[i]
+        x1, y1, on1 = points[(i + 1) % count]
+        polygon.append((x0 * scale, -y0 * scale))
+        if on1:
+            i += 1
+            continue
+        x2, y2, on2 = points[(i + 2) % count]
+        steps = max(2, int(math.hypot(x2 - x0, y2 - y0) * scale / 2))
+        for s in range(1, steps):
+            t = s / float(steps)
+            u = 1.0 - t
+            x = (u * u * x0) + (2 * u * t * x1) + (t * t * x2)
+            y = (u * u * y0) + (2 * u * t * y1) + (t * t * y2)
+            polygon.append((x * scale, -y * scale))
+        i += 2
+    return polygon
+
+
+def RasterizePolygons(polygons):
+    """Computes anti-aliased coverage of polygons using the non-zero winding rule. Returns (left, top, width, height, coverage)."""
+    points = [p for polygon in polygons for p in polygon]
+    if not points:
+        return 0, 0, 0, 0, []
+    left = int(math.floor(min(p[0] for p in points)))
+    top = int(math.floor(min(p[1] for p in points)))
+    width = int(math.ceil(max(p[0] for p in points))) - left
+    height = int(math.ceil(max(p[1] for p in points))) - top
+    coverage = [0.0] * (width * height)
+
+    edges = []
+    for polygon in polygons:
+        for i in range(len(polygon)):
+            x0, y0 = polygon[i]
+            x1, y1 = polygon[(i + 1) % len(polygon)]
+            if y0 != y1:
+                edges.append((x0 - left, y0 - top, x1 - left, y1 - top))
+
+    for row in range(height * SUBSAMPLES):
+        sy = (row + 0.5) / SUBSAMPLES
+        crossings = []
+        for x0, y0, x1, y1 in edges:
+            if (y0 <= sy < y1) or (y1 <= sy < y0):
+                x = x0 + ((sy - y0) * (x1 - x0) / (y1 - y0))
+                crossings.append((x, 1 if y1 > y0 else -1))
+        crossings.sort()
+        winding = 0
+        base = (row // SUBSAMPLES) * width
+        for i in range(len(crossings) - 1):
+            winding += crossings[i][1]
+            if winding == 0:
+                continue
+            # Add the exact horizontal coverage of the span to each pixel it touches.
+            a = max(crossings[i][0], 0.0)
+            b = min(crossings[i + 1][0], float(width))
+            x = int(a)
+            while x < b and x < width:
+                coverage[base + x] += (min(b, x + 1) - max(a, x)) / SUBSAMPLES
+                x += 1
+    return left, top, width, height, [min(c, 1.0) for c in coverage]
+
+
+def LoadTrueType(path, size, codepoints):
+    with open(path, "rb") as f:
+        ttf = TrueType(f.read())
+    scale = size / float(ttf.unitsPerEm)
+    font = Font()
+    font.baseline = int(math.ceil(ttf.ascent * scale))
+    font.height = font.baseline + int(math.ceil(-ttf.descent * scale)) + int(round(ttf.lineGap * scale))
+
+    indices = {}
+    for c in codepoints:
+        index = ttf.cmap.get(c, 0)
+        if index == 0 and c != 32:
+            continue
+        indices[index] = c
+        polygons = [FlattenContour(contour, scale) for contour in ttf.GetContours(index) if contour]
+        left, top, width, height, coverage = RasterizePolygons(polygons)
+        advance = int(round(ttf.GetAdvance(index) * scale))
+        font.glyphs[c] = Glyph(c, advance, left, top + font.baseline, width, height, coverage)
+
+    for (a, b), value in ttf.GetKerning().items():
+        if a in indices and b in indices:
+            adjust = int(round(value * scale))
+            if adjust != 0:
+                font.kerning[(indices[a], indices[b])] = adjust
+    return font
+
+
+#
+# BDF
+#
+
+def LoadBDF(path, codepoints):
+    font = Font()
+    ascent = descent = 0
+    glyph = None
+    bitmap = None
+    with open(path, "r", encoding="latin-1") as f:
+        for line in f:
+            words = line.split()
+            if not words:
+                continue
+            key = words[0]
+            if bitmap is not None:
+                if key == "ENDCHAR":
+                    code, advance, w, h, xoff, yoff = glyph
+                    if code in codepoints:
+                        coverage = []
+                        for row in bitmap[:h]:
+                            bits = int(row, 16)
+                            total = len(row) * 4
+                            coverage.extend([float((bits >> (total - 1 - x)) & 1) for x in range(w)])
+                        font.glyphs[code] = Glyph(code, advance, xoff, ascent - (yoff + h), w, h, coverage)
+                    bitmap = None
+                else:
+                    bitmap.append(key)
+            elif key == "FONT_ASCENT":
+                ascent = int(words[1])
+            elif key == "FONT_DESCENT":
+                descent = int(words[1])
+            elif key == "STARTCHAR":
+                glyph = [-1, 0, 0, 0, 0, 0]
+            elif key == "ENCODING":
+                glyph[0] = int(words[1])
+            elif key == "DWIDTH":
+                glyph[1] = int(words[1])
+            elif key == "BBX":
+                glyph[2:6] = [int(v) for v in words[1:5]]
+            elif key == "BITMAP":
+                bitmap = []
+    font.baseline = ascent
+    font.height = ascent + descent
+    return font
+
+
+#
+# Output
+#
+
+def Pack(glyph, bpp):
+    """Quantizes and packs glyph coverage, most significant bits first, with each row starting on a new byte."""
+    levels = (1 << bpp) - 1
+    data = []
+    for y in range(glyph.height):
+        byte = 0
+        used = 0
+        for x in range(glyph.width):
+            level = int(round(glyph.coverage[(y * glyph.width) + x] * levels))
+            byte = (byte << bpp) | level
+            used += bpp
+            if used == 8:
+                data.append(byte)
+                byte = 0
+                used = 0
+        if used > 0:
+            data.append(byte << (8 - used))
+    return data
+
+
+def Trim(glyph):
+    """Removes empty rows and columns around a glyph bitmap."""
+    rows = [y for y in range(glyph.height) if any(glyph.coverage[(y * glyph.width) + x] >= 1.0 / 32 for x in range(glyph.width))]
+    cols = [x for x in range(glyph.width) if any(glyph.coverage[(y * glyph.width) + x] >= 1.0 / 32 for y in range(glyph.height))]
+    if not rows or not cols:
+        glyph.width = glyph.height = 0
+        glyph.coverage = []
+        return
+    x0, x1, y0, y1 = cols[0], cols[-1] + 1, rows[0], rows[-1] + 1
+    glyph.coverage = [glyph.coverage[(y * glyph.width) + x] for y in range(y0, y1) for x in range(x0, x1)]
+    glyph.left += x0
+    glyph.top += y0
+    glyph.width = x1 - x0
+    glyph.height = y1 - y0
+
+
+def Clamp(value, low, high, what):
+    if value < low or value > high:
+        raise ValueError("%s of %d doesn't fit the baked font format" % (what, value))
+    return value
+
+
+def WriteHeader(font, name, bpp, first, last, source, output):
+    guard = "FONT_%s_H" % name.upper()
+    lines = []
+    lines.append("// Generated by tools/bakefont.py from %s, do not edit." % os.path.basename(source))
+    lines.append("#ifndef %s" % guard)
+    lines.append("#define %s" % guard)
+    lines.append("")
+    lines.append('#include "../font.h"')
+    lines.append("")
+
+    bitmaps = []
+    glyphs = []
+    for c in range(first, last + 1):
+        glyph = font.glyphs.get(c)
+        if glyph is None:
+            glyphs.append("    {0, 0, 0, 0, 0, 0}, // missing U+%04X" % c)
+            continue
+        Trim(glyph)
+        offset = len(bitmaps)
+        bitmaps.extend(Pack(glyph, bpp))
+        label = chr(c) if 32 < c < 127 and c != 92 else "U+%04X" % c
+        glyphs.append("    {%d, %d, %d, %d, %d, %d}, // %s" % (
+            offset,
+            Clamp(glyph.width, 0, 255, "Width"),
+            Clamp(glyph.height, 0, 255, "Height"),
+            Clamp(glyph.left, -128, 127, "Left offset"),
+            Clamp(glyph.top, -128, 127, "Top offset"),
+            Clamp(glyph.advance, 0, 255, "Advance"),
+            label
+        ))
+
+    lines.append("constexpr uint8_t %s_Bitmaps[] = {" % name)
+    for i in range(0, max(len(bitmaps), 1), 16):
+        chunk = bitmaps[i:i + 16] if bitmaps else [0]
+        lines.append("    " + ", ".join("0x%02X" % b for b in chunk) + ",")
+    lines.append("};")
+    lines.append("")
+
+    lines.append("constexpr BakedGlyph %s_Glyphs[] = {" % name)
+    lines.extend(glyphs)
+    lines.append("};")
+    lines.append("")
+
+    kerning = sorted((a, b, v) for (a, b), v in font.kerning.items() if first <= a <= last and first <= b <= last)
+    if kerning:
+        lines.append("constexpr BakedKerning %s_Kerning[] = {" % name)
+        for a, b, v in kerning:
+            lines.append("    {%d, %d, %d}," % (a, b, Clamp(v, -128, 127, "Kerning")))
+        lines.append("};")
+        lines.append("")
+
+    lines.append("constexpr BakedFont %s = {" % name)
+    lines.append("    %s_Bitmaps," % name)
+    lines.append("    %s_Glyphs," % name)
+    lines.append("    %s," % ("%s_Kerning" % name if kerning else "nullptr"))
+    lines.append("    %d, // First codepoint" % first)
+    lines.append("    %d, // Glyph count" % (last - first + 1))
+    lines.append("    %d, // Kerning pair count" % len(kerning))
+    lines.append("    %d, // Bits per pixel" % bpp)
+    lines.append("    %d, // Line height" % Clamp(font.height, 1, 255, "Line height"))
+    lines.append("    %d, // Baseline" % Clamp(font.baseline, 0, 255, "Baseline"))
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // %s" % guard)
+
+    text = "\n".join(lines) + "\n"
+    if output:
+        with open(output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    return len(bitmaps)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Bake a TrueType or BDF font into constexpr tables for FancyWatchOS.")
+    parser.add_argument("font", help="path to a .ttf or .bdf font")
+    parser.add_argument("--name", required=True, help="C++ identifier of the baked font")
+    parser.add_argument("--size", type=float, default=16, help="pixel size of the em square, TrueType only")
+    parser.add_argument("--bpp", type=int, choices=(1, 2, 4), default=4, help="bits per pixel of glyph bitmaps")
+    parser.add_argument("--first", type=int, default=32, help="first codepoint to bake")
+    parser.add_argument("--last", type=int, default=126, help="last codepoint to bake")
+    parser.add_argument("--output", help="header to write, defaults to stdout")
+    args = parser.parse_args()
+
+    codepoints = set(range(args.first, args.last + 1))
+    if args.font.lower().endswith(".bdf"):
+        font = LoadBDF(args.font, codepoints)
+    else:
+        font = LoadTrueType(args.font, args.size, codepoints)
+
+    size = WriteHeader(font, args.name, args.bpp, args.first, args.last, args.font, args.output)
+    sys.stderr.write("Baked %d glyphs, %d bytes of bitmaps, %d kerning pairs\n" % (len(font.glyphs), size, len(font.kerning)))
+
+
+if __name__ == "__main__":
+    main()
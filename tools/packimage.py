@@ -0,0 +1,268 @@
+#!/usr/bin/env python3
+"""Packs a PNG or binary PPM image into a C++ header holding a compressed RGB565 PackedImage for FancyWatchOS.
+
+Each row is encoded as a sequence of ops: literal pixels, runs of one pixel and copies of the same columns from the row
+above, see PackedImageOp in src/image.h. Ops never cross the end of a row, so the image can be decoded a row at a time.
+Transparency is dropped by blending over a background colour. No third party modules are required.
+
+Usage:
+    packimage.py face.png --name WatchFace --output src/images/watchface.h
+    packimage.py icon.ppm --name Icon --background 0x000000
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+OP_LITERAL = 0
+OP_RUN = 1
+OP_COPY_UP = 2
+
+# Largest pixel count of a single op, 64 plus one extra count byte.
+MAX_COUNT = 64 + 255
+
+
+#
+# Image loading
+#
+
+def Paeth(a, b, c):
+    p = a + b - c
+    pa = abs(p - a)
+    pb = abs(p - b)
+    pc = abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def LoadPNG(data, background):
+    """Returns (width, height, rows of (r, g, b) tuples) for a non-interlaced 8-bit PNG."""
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("not a PNG file")
+    offset = 8
+    idat = b""
+    palette = []
+    alphas = []
+    width = height = depth = colorType = interlace = 0
+    while offset < len(data):
+        length, tag = struct.unpack_from(">I4s", data, offset)
+        chunk = data[offset + 8:offset + 8 + length]
+        offset += 12 + length
+        if tag == b"IHDR":
+            width, height, depth, colorType, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif tag == b"PLTE":
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, len(chunk), 3)]
+        elif tag == b"tRNS":
+            alphas = list(chunk)
+        elif tag == b"IDAT":
+            idat += chunk
+        elif tag == b"IEND":
+            break
+    if depth != 8 or interlace != 0:
+        raise ValueError("only non-interlaced PNGs with 8 bits per channel are supported")
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(colorType)
+    if channels is None:
+        raise ValueError("unsupported PNG colour type %d" % colorType)
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    previous = bytearray(stride)
+    rows = []
+    pos = 0
+    for y in range(height):
+        kind = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            left = line[i - channels] if i >= channels else 0
+            up = previous[i]
+            corner = previous[i - channels] if i >= channels else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + ((left + up) >> 1)) & 0xFF
+            elif kind == 4:
+                line[i] = (line[i] + Paeth(left, up, corner)) & 0xFF
+        previous = line
+
+        pixels = []
+        for x in range(width):
+            p = line[x * channels:(x + 1) * channels]
+            if colorType == 0:
+                r = g = b = p[0]
+                a = 255
+            elif colorType == 2:
+                r, g, b = p
+                a = 255
+            elif colorType == 3:
+                r, g, b = palette[p[0]]
+                a = alphas[p[0]] if p[0] < len(alphas) else 255
+            elif colorType == 4:
+                r = g = b = p[0]
+                a = p[1]
+            else:
+                r, g, b, a = p
+            pixels.append(Blend((r, g, b), background, a))
+        rows.append(pixels)
+    return width, height, rows
+
+
+def LoadPPM(data):
+    """Returns (width, height, rows of (r, g, b) tuples) for a binary (P6) PPM with 8-bit channels."""
+    fields = []
+    pos = 2
+    if data[:2] != b"P6":
+        raise ValueError("only binary (P6) PPM files are supported")
+    while len(fields) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        fields.append(int(data[start:pos]))
+    width, height, maxval = fields
+    if maxval != 255:
+        raise ValueError("only PPM files with 8-bit channels are supported")
+    pos += 1
+    rows = []
+    for y in range(height):
+        rows.append([tuple(data[pos + (x * 3):pos + (x * 3) + 3]) for x in range(width)])
+        pos += width * 3
+    return width, height, rows
+
+
+def Blend(color, background, alpha):
+    return tuple(((c * alpha) + (bg * (255 - alpha)) + 127) // 255 for c, bg in zip(color, background))
+
+
+def ToRGB565(color):
+    r, g, b = color
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+
+
+#
+# Encoding
+#
+
+def EncodeOp(out, op, count):
+    if count < 64:
+        out.append((op << 6) | (count - 1))
+    else:
+        out.append((op << 6) | 0x3F)
+        out.append(count - 64)
+
+
+def EncodeRow(out, row, above):
+    """Appends the ops for a row of RGB565 pixels, greedily picking whichever op covers the most pixels."""
+    width = len(row)
+    literal = []
+
+    def FlushLiteral():
+        while literal:
+            chunk = literal[:MAX_COUNT]
+            del literal[:MAX_COUNT]
+            EncodeOp(out, OP_LITERAL, len(chunk))
+            for pixel in chunk:
+                out.extend(struct.pack("<H", pixel))
+
+    x = 0
+    while x < width:
+        run = 1
+        while x + run < width and run < MAX_COUNT and row[x + run] == row[x]:
+            run += 1
+        up = 0
+        if above is not None:
+            while x + up < width and up < MAX_COUNT and row[x + up] == above[x + up]:
+                up += 1
+
+        # A copy costs 1 byte and a run 3, against 2 bytes per literal pixel.
+        if up >= 2 and up >= run:
+            FlushLiteral()
+            EncodeOp(out, OP_COPY_UP, up)
+            x += up
+        elif run >= 3 or (run == 2 and not literal):
+            FlushLiteral()
+            EncodeOp(out, OP_RUN, run)
+            out.extend(struct.pack("<H", row[x]))
+            x += run
+        else:
+            literal.append(row[x])
+            x += 1
+    FlushLiteral()
+
+
+def Encode(rows):
+    out = bytearray()
+    above = None
+    for row in rows:
+        EncodeRow(out, row, above)
+        above = row
+    return out
+
+
+def WriteHeader(data, name, width, height, source, output):
+    guard = "IMAGE_%s_H" % name.upper()
+    lines = []
+    lines.append("// Generated by tools/packimage.py from %s, do not edit." % os.path.basename(source))
+    lines.append("#ifndef %s" % guard)
+    lines.append("#define %s" % guard)
+    lines.append("")
+    lines.append('#include "../image.h"')
+    lines.append("")
+    lines.append("constexpr uint8_t %s_Data[] = {" % name)
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("constexpr PackedImage %s = {" % name)
+    lines.append("    %s_Data," % name)
+    lines.append("    %d, // Size in bytes" % len(data))
+    lines.append("    %d, // Width" % width)
+    lines.append("    %d, // Height" % height)
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // %s" % guard)
+
+    text = "\n".join(lines) + "\n"
+    if output:
+        with open(output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack a PNG or PPM image into a compressed RGB565 PackedImage for FancyWatchOS.")
+    parser.add_argument("image", help="path to a .png or binary .ppm image")
+    parser.add_argument("--name", required=True, help="C++ identifier of the packed image")
+    parser.add_argument("--background", default="0x000000", help="RGB colour that transparent pixels are blended over")
+    parser.add_argument("--output", help="header to write, defaults to stdout")
+    args = parser.parse_args()
+
+    background = int(args.background, 16)
+    background = ((background >> 16) & 0xFF, (background >> 8) & 0xFF, background & 0xFF)
+    with open(args.image, "rb") as f:
+        data = f.read()
+    if args.image.lower().endswith(".ppm"):
+        width, height, rows = LoadPPM(data)
+    else:
+        width, height, rows = LoadPNG(data, background)
+    if width > 0xFFFF or height > 0xFFFF:
+        raise ValueError("image is too large")
+
+    packed = Encode([[ToRGB565(pixel) for pixel in row] for row in rows])
+    WriteHeader(packed, args.name, width, height, args.image, args.output)
+    raw = width * height * 2
+    sys.stderr.write("Packed %dx%d image into %d bytes, %.1f%% of %d raw bytes\n" % (width, height, len(packed), 100.0 * len(packed) / max(raw, 1), raw))
+
+
+if __name__ == "__main__":
+    main()